@@ -0,0 +1,331 @@
+// Microbenchmarks for the spatial structures, intersection tests, ticks and
+// snapshots
+// Usage: 2d-physics-bench [--csv] [--repeats N] [--levels <dir>]
+// Results are printed to standard output as JSON, or as CSV with --csv
+// Levels are read from the directory the build generated them in, unless
+// --levels is given
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "objects.hpp"
+#include "quadtree.hpp"
+#include "snapshot.hpp"
+#include "treeitem.hpp"
+#include "util.hpp"
+#include "world.hpp"
+
+using std::cout, std::cerr;
+using std::sort;
+using std::string;
+using std::vector;
+
+using Clock = std::chrono::steady_clock;
+
+// Printed with --help, or when the arguments aren't valid
+const char USAGE[] = "Usage: 2d-physics-bench [--csv] [--repeats N] [--levels <dir>]\n";
+
+// Same seed every run, so that results are comparable between runs
+const unsigned BENCH_SEED = 12345;
+
+// Minimal item for filling a QuadTree without a PhysicsWorld
+struct BenchItem : public QuadTreeItem {
+    AABB bounds;
+
+    BenchItem(AABB bounds) : bounds(bounds) {}
+
+    AABB getBounds() const { return this->bounds; }
+};
+
+struct BenchResult {
+    string    name;
+    long long opsPerRun; // Operations timed in each run
+    int       repeats;
+    double    nsMedian;  // Nanoseconds per operation
+    double    nsMin;
+};
+
+vector<BenchResult> results;
+
+int repeats = 15;
+
+// Simulated by the tick and snapshot cases
+World world;
+
+// Keeps the compiler from optimizing the measured work away
+volatile long long sink = 0;
+
+// Parses a whole argument as an int which is at least minimum
+// Returns false if it isn't one, in which case value is left untouched
+bool parseInt(const char* arg, int minimum, int& value) {
+    size_t length = 0;
+    int    parsed;
+
+    try {
+        parsed = std::stoi(arg, &length);
+    } catch (const std::logic_error&) {
+        // Not a number, or out of range
+        return false;
+    }
+
+    if (arg[length] != '\0' || parsed < minimum) return false;
+
+    value = parsed;
+    return true;
+}
+
+// Time run() repeats times after one warmup run, calling setup() before each
+// run without timing it
+template <typename S, typename F>
+void measure(string name, long long opsPerRun, S setup, F run) {
+    vector<double> times;
+
+    for (int i = 0; i <= repeats; i++) {
+        setup();
+
+        Clock::time_point start = Clock::now();
+        run();
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+        // The first run only warms up caches and pools
+        if (i > 0) {
+            times.push_back(ns/opsPerRun);
+        }
+    }
+
+    sort(times.begin(), times.end());
+
+    results.push_back({name, opsPerRun, repeats, times[times.size()/2], times[0]});
+}
+
+template <typename F>
+void measure(string name, long long opsPerRun, F run) {
+    measure(name, opsPerRun, []() {}, run);
+}
+
+// Boxes of the given half size, spread over the window
+vector<BenchItem> makeItems(int count, double minHalf, double maxHalf, std::mt19937& rng) {
+    std::uniform_real_distribution<double> x(maxHalf, WINDOW_WIDTH - maxHalf);
+    std::uniform_real_distribution<double> y(maxHalf, WINDOW_HEIGHT - maxHalf);
+    std::uniform_real_distribution<double> half(minHalf, maxHalf);
+
+    vector<BenchItem> items;
+    items.reserve(count);
+
+    for (int i = 0; i < count; i++) {
+        items.push_back({AABB({x(rng), y(rng)}, half(rng), half(rng))});
+    }
+
+    return items;
+}
+
+AABB windowBounds() {
+    return AABB(
+        {WINDOW_WIDTH/2, WINDOW_HEIGHT/2},
+        (WINDOW_WIDTH/2) - 2,
+        (WINDOW_HEIGHT/2) - 2
+    );
+}
+
+void benchQuadTreeInsert(std::mt19937& rng) {
+    for (int count : {1000, 10000, 100000}) {
+        vector<BenchItem>   items = makeItems(count, 1, 8, rng);
+        QuadTree<BenchItem> tree(windowBounds());
+
+        measure("quadtree_insert_clear/" + std::to_string(count), count, [&]() {
+            tree.clear();
+
+            for (BenchItem& item : items) {
+                tree.insert(&item);
+            }
+        });
+    }
+}
+
+void benchQuadTreeQuery(std::mt19937& rng) {
+    const int ITEMS   = 10000;
+    const int QUERIES = 10000;
+
+    vector<BenchItem>   items = makeItems(ITEMS, 1, 8, rng);
+    QuadTree<BenchItem> tree(windowBounds());
+
+    for (BenchItem& item : items) {
+        tree.insert(&item);
+    }
+
+    for (double half : {4.0, 16.0, 64.0}) {
+        vector<BenchItem>  queries = makeItems(QUERIES, half, half, rng);
+        vector<BenchItem*> acc;
+
+        measure("quadtree_find/" + std::to_string(static_cast<int>(half*2)), QUERIES, [&]() {
+            for (BenchItem& query : queries) {
+                acc.clear();
+                tree.findPossibleCollisions(query.bounds, acc);
+                sink += acc.size();
+            }
+        });
+    }
+}
+
+void benchIntersects(std::mt19937& rng) {
+    const int PAIRS = 1000000;
+
+    vector<BenchItem> boxes  = makeItems(PAIRS, 1, 32, rng);
+    vector<BenchItem> others = makeItems(PAIRS, 1, 32, rng);
+
+    measure("aabb_intersects", PAIRS, [&]() {
+        long long hits = 0;
+
+        for (int i = 0; i < PAIRS; i++) {
+            AABBCommon& box = boxes[i].bounds;
+            hits += (box.intersects(others[i].bounds) != INTERSECT_NONE);
+        }
+
+        sink += hits;
+    });
+
+    measure("intersect_boxes", PAIRS, [&]() {
+        long long hits = 0;
+
+        for (int i = 0; i < PAIRS; i++) {
+            hits += (intersectBoxes(boxes[i].bounds, others[i].bounds) != INTERSECT_NONE);
+        }
+
+        sink += hits;
+    });
+}
+
+// Reload the test level, with the given number of projectiles and nothing else
+// Exits if the level doesn't exist, as there would be nothing to measure
+void spawnProjectiles(int count) {
+    world.clear();
+
+    if (world.loadLevel("test") == nullptr) {
+        cerr << "ERROR: Level \"test\" doesn't exist in " << world.levelsDirectory << '\n';
+        std::exit(1);
+    }
+
+    for (int i = 0; i < count; i++) {
+        Projectile* proj = world.projectilePool.create(world.physics, world.playerPool, nullptr, -1, 15, 15);
+
+        proj->teleport(
+            16 + (i*37) % (WINDOW_WIDTH - 32),
+            16 + (i*53) % (WINDOW_HEIGHT - 32)
+        );
+        proj->setWeight(0.85);
+        proj->thrust((i % 21) - 10, -(i % 13));
+
+        world.addGameObject(proj);
+    }
+}
+
+void benchTick() {
+    const int TICKS = 10;
+
+    for (int count : {100, 1000, 10000}) {
+        // Respawn the same objects before each run, so every run simulates
+        // the same ticks
+        auto setup = [count]() {
+            spawnProjectiles(count);
+        };
+
+        measure("tick/" + std::to_string(count), TICKS, setup, [&]() {
+            for (int i = 0; i < TICKS; i++) {
+                world.step();
+            }
+        });
+    }
+
+    world.clear();
+}
+
+void benchSnapshot() {
+    const int SNAPSHOTS = 10;
+
+    vector<uint8_t> buffer;
+
+    for (int count : {100, 1000, 10000}) {
+        spawnProjectiles(count);
+
+        measure("snapshot_save/" + std::to_string(count), SNAPSHOTS, [&]() {
+            for (int i = 0; i < SNAPSHOTS; i++) {
+                saveSnapshot(world, buffer);
+            }
+        });
+
+        measure("snapshot_restore/" + std::to_string(count), SNAPSHOTS, [&]() {
+            for (int i = 0; i < SNAPSHOTS; i++) {
+                sink += restoreSnapshot(world, buffer.data(), buffer.size());
+            }
+        });
+    }
+
+    world.clear();
+}
+
+int main(int argc, char** argv) {
+    bool csv = false;
+
+    // Anything unknown, missing its value or with an invalid one is rejected
+    // before any benchmark runs
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
+            cout << USAGE;
+            return 0;
+        } else if (strcmp(argv[i], "--csv") == 0) {
+            csv = true;
+        } else if (strcmp(argv[i], "--repeats") == 0 && i + 1 < argc && parseInt(argv[i + 1], 1, repeats)) {
+            i++;
+        } else if (strcmp(argv[i], "--levels") == 0 && i + 1 < argc) {
+            world.levelsDirectory = argv[++i];
+        } else {
+            cerr << USAGE;
+            return 1;
+        }
+    }
+
+    std::mt19937 rng(BENCH_SEED);
+
+    benchQuadTreeInsert(rng);
+    benchQuadTreeQuery(rng);
+    benchIntersects(rng);
+    benchTick();
+    benchSnapshot();
+
+    if (csv) {
+        cout << "name,ops_per_run,repeats,ns_per_op_median,ns_per_op_min\n";
+
+        for (BenchResult& result : results) {
+            cout << result.name << ','
+                 << result.opsPerRun << ','
+                 << result.repeats << ','
+                 << result.nsMedian << ','
+                 << result.nsMin << '\n';
+        }
+    } else {
+        cout << "{\n  \"benchmarks\": [\n";
+
+        for (size_t i = 0; i < results.size(); i++) {
+            BenchResult& result = results[i];
+
+            cout << "    {\"name\": \""           << result.name
+                 << "\", \"ops_per_run\": "       << result.opsPerRun
+                 << ", \"repeats\": "             << result.repeats
+                 << ", \"ns_per_op_median\": "    << result.nsMedian
+                 << ", \"ns_per_op_min\": "       << result.nsMin
+                 << ((i + 1 < results.size()) ? "},\n" : "}\n");
+        }
+
+        cout << "  ]\n}\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,160 @@
+#include "boxbatch.hpp"
+
+#include <cstdint>
+
+#if defined(__AVX__)
+    #include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+#endif
+
+#include "util.hpp"
+
+/* -- BoxBatch -- */
+
+void BoxBatch::clear()        { this->count = 0; }
+bool BoxBatch::isFull() const { return this->count >= BOX_BATCH_SIZE; }
+
+/* -- Batched intersection tests -- */
+
+uint64_t intersectBatch(
+    double          topY,
+    double          bottomY,
+    double          leftX,
+    double          rightX,
+    const BoxBatch& batch,
+    vec2<int>*      sides
+) {
+    /*
+     * Every comparison needed by AABBCommon::intersects is done for all boxes
+     * first, with one bit per box in each of these masks. The hit mask and
+     * side codes are then worked out from the masks.
+     *
+     * Boxes past batch.count are compared as well, to keep the loops simple,
+     * but their bits are discarded at the end
+     */
+    uint64_t hits        = 0; // Intersects on both axes
+    uint64_t touchLeft   = 0; // This box's right side is inside the other
+    uint64_t touchRight  = 0; // This box's left side is inside the other
+    uint64_t touchTop    = 0; // This box's bottom side is inside the other
+    uint64_t touchBottom = 0; // This box's top side is inside the other
+
+#if defined(__AVX__)
+    const int LANES = 4;
+
+    __m256d top    = _mm256_set1_pd(topY);
+    __m256d bottom = _mm256_set1_pd(bottomY);
+    __m256d left   = _mm256_set1_pd(leftX);
+    __m256d right  = _mm256_set1_pd(rightX);
+
+    for (int i = 0; i < batch.count; i += LANES) {
+        __m256d otherTop    = _mm256_load_pd(batch.topY + i);
+        __m256d otherBottom = _mm256_load_pd(batch.bottomY + i);
+        __m256d otherLeft   = _mm256_load_pd(batch.leftX + i);
+        __m256d otherRight  = _mm256_load_pd(batch.rightX + i);
+
+        __m256d hit = _mm256_and_pd(
+            _mm256_and_pd(
+                _mm256_cmp_pd(right, otherLeft, _CMP_GT_OQ),
+                _mm256_cmp_pd(left, otherRight, _CMP_LT_OQ)
+            ),
+            _mm256_and_pd(
+                _mm256_cmp_pd(bottom, otherTop, _CMP_GT_OQ),
+                _mm256_cmp_pd(top, otherBottom, _CMP_LT_OQ)
+            )
+        );
+
+        hits |= uint64_t(_mm256_movemask_pd(hit)) << i;
+
+        if (sides == nullptr) continue;
+
+        __m256d leftLess   = _mm256_cmp_pd(left, otherLeft, _CMP_LT_OQ);
+        __m256d leftMore   = _mm256_cmp_pd(left, otherLeft, _CMP_GT_OQ);
+        __m256d rightLess  = _mm256_cmp_pd(right, otherRight, _CMP_LT_OQ);
+        __m256d rightMore  = _mm256_cmp_pd(right, otherRight, _CMP_GT_OQ);
+        __m256d topLess    = _mm256_cmp_pd(top, otherTop, _CMP_LT_OQ);
+        __m256d topMore    = _mm256_cmp_pd(top, otherTop, _CMP_GT_OQ);
+        __m256d bottomLess = _mm256_cmp_pd(bottom, otherBottom, _CMP_LT_OQ);
+        __m256d bottomMore = _mm256_cmp_pd(bottom, otherBottom, _CMP_GT_OQ);
+
+        touchLeft   |= uint64_t(_mm256_movemask_pd(_mm256_and_pd(leftLess, rightLess))) << i;
+        touchRight  |= uint64_t(_mm256_movemask_pd(_mm256_and_pd(leftMore, rightMore))) << i;
+        touchTop    |= uint64_t(_mm256_movemask_pd(_mm256_and_pd(topLess, bottomLess))) << i;
+        touchBottom |= uint64_t(_mm256_movemask_pd(_mm256_and_pd(topMore, bottomMore))) << i;
+    }
+#elif defined(__SSE2__) || defined(_M_X64)
+    const int LANES = 2;
+
+    __m128d top    = _mm_set1_pd(topY);
+    __m128d bottom = _mm_set1_pd(bottomY);
+    __m128d left   = _mm_set1_pd(leftX);
+    __m128d right  = _mm_set1_pd(rightX);
+
+    for (int i = 0; i < batch.count; i += LANES) {
+        __m128d otherTop    = _mm_load_pd(batch.topY + i);
+        __m128d otherBottom = _mm_load_pd(batch.bottomY + i);
+        __m128d otherLeft   = _mm_load_pd(batch.leftX + i);
+        __m128d otherRight  = _mm_load_pd(batch.rightX + i);
+
+        __m128d hit = _mm_and_pd(
+            _mm_and_pd(_mm_cmpgt_pd(right, otherLeft), _mm_cmplt_pd(left, otherRight)),
+            _mm_and_pd(_mm_cmpgt_pd(bottom, otherTop), _mm_cmplt_pd(top, otherBottom))
+        );
+
+        hits |= uint64_t(_mm_movemask_pd(hit)) << i;
+
+        if (sides == nullptr) continue;
+
+        touchLeft   |= uint64_t(_mm_movemask_pd(_mm_and_pd(
+                           _mm_cmplt_pd(left, otherLeft), _mm_cmplt_pd(right, otherRight)
+                       ))) << i;
+        touchRight  |= uint64_t(_mm_movemask_pd(_mm_and_pd(
+                           _mm_cmpgt_pd(left, otherLeft), _mm_cmpgt_pd(right, otherRight)
+                       ))) << i;
+        touchTop    |= uint64_t(_mm_movemask_pd(_mm_and_pd(
+                           _mm_cmplt_pd(top, otherTop), _mm_cmplt_pd(bottom, otherBottom)
+                       ))) << i;
+        touchBottom |= uint64_t(_mm_movemask_pd(_mm_and_pd(
+                           _mm_cmpgt_pd(top, otherTop), _mm_cmpgt_pd(bottom, otherBottom)
+                       ))) << i;
+    }
+#else
+    for (int i = 0; i < batch.count; i++) {
+        uint64_t bit = uint64_t(1) << i;
+
+        if (rightX  > batch.leftX[i] && leftX < batch.rightX[i]
+        &&  bottomY > batch.topY[i]  && topY  < batch.bottomY[i]) {
+            hits |= bit;
+        }
+
+        if (sides == nullptr) continue;
+
+        if (leftX < batch.leftX[i] && rightX < batch.rightX[i]) touchLeft |= bit;
+        if (leftX > batch.leftX[i] && rightX > batch.rightX[i]) touchRight |= bit;
+        if (topY < batch.topY[i] && bottomY < batch.bottomY[i]) touchTop |= bit;
+        if (topY > batch.topY[i] && bottomY > batch.bottomY[i]) touchBottom |= bit;
+    }
+#endif
+
+    // Discard the bits of boxes past the end of the batch
+    if (batch.count < BOX_BATCH_SIZE) {
+        hits &= (uint64_t(1) << batch.count) - 1;
+    }
+
+    if (sides == nullptr) return hits;
+
+    // A box which is neither touching one side or the other contains/is
+    // contained by the other box on that axis
+    for (uint64_t remaining = hits; remaining != 0; remaining &= remaining - 1) {
+        int i = lowestBit(remaining);
+
+        sides[i].x = INTERSECT_X_BOTH
+                   - ((touchLeft >> i) & 1)*(INTERSECT_X_BOTH - INTERSECT_X_LEFT)
+                   - ((touchRight >> i) & 1)*(INTERSECT_X_BOTH - INTERSECT_X_RIGHT);
+        sides[i].y = INTERSECT_Y_BOTH
+                   - ((touchTop >> i) & 1)*(INTERSECT_Y_BOTH - INTERSECT_Y_TOP)
+                   - ((touchBottom >> i) & 1)*(INTERSECT_Y_BOTH - INTERSECT_Y_BOTTOM);
+    }
+
+    return hits;
+}
@@ -0,0 +1,70 @@
+// Batched intersection tests of one box against many others
+
+#ifndef BOXBATCH_HPP
+#define BOXBATCH_HPP
+
+#include <cstdint>
+
+#include "util.hpp"
+
+// Max number of boxes in a BoxBatch, one per bit of a hit mask
+const int BOX_BATCH_SIZE = 64;
+
+/*
+ * A fixed-size block of box bounds, stored as a structure of arrays so that
+ * several boxes can be tested at once with SIMD instructions
+ *
+ * Only stores bounds, so callers should keep track of which item each box
+ * belongs to (e.g. in an array indexed the same way)
+ */
+struct BoxBatch {
+    alignas(32) double topY[BOX_BATCH_SIZE]    = {};
+    alignas(32) double bottomY[BOX_BATCH_SIZE] = {};
+    alignas(32) double leftX[BOX_BATCH_SIZE]   = {};
+    alignas(32) double rightX[BOX_BATCH_SIZE]  = {};
+    int                count                   = 0;
+
+    void clear();
+    bool isFull() const;
+
+    // Append a box's bounds to the batch
+    // PS: will *not* check if the batch is full!
+    template <typename B>
+    void add(const B& box);
+};
+
+/*
+ * Test a box against every box in the batch at once
+ *
+ * Returns a mask with bit i set if the box intersects the batch's i-th box,
+ * following the same rules as AABBCommon::intersects. For every set bit,
+ * sides[i] receives the direction of the intersection (INTERSECT_X_* and
+ * INTERSECT_Y_* values); the other entries of sides are left untouched.
+ * sides can be nullptr, in which case the directions aren't worked out at all.
+ *
+ * Uses AVX (4 boxes per instruction) when compiled with it enabled, SSE2 (2
+ * boxes per instruction) otherwise, or plain scalar code on platforms that
+ * support neither
+ */
+uint64_t intersectBatch(
+    double          topY,
+    double          bottomY,
+    double          leftX,
+    double          rightX,
+    const BoxBatch& batch,
+    vec2<int>*      sides
+);
+
+// Same as above, reading the bounds from any box type
+template <typename B>
+uint64_t intersectBatch(const B& box, const BoxBatch& batch, vec2<int>* sides);
+
+// Index of the lowest set bit in a non-zero mask
+inline int lowestBit(uint64_t mask);
+
+// Number of set bits in a mask
+inline int countBits(uint64_t mask);
+
+#include "boxbatch.tpp"
+
+#endif
@@ -0,0 +1,58 @@
+#include "boxbatch.hpp"
+
+#include <cstdint>
+
+/* -- BoxBatch -- */
+
+template <typename B>
+void BoxBatch::add(const B& box) {
+    this->topY[this->count]    = box.getTopY();
+    this->bottomY[this->count] = box.getBottomY();
+    this->leftX[this->count]   = box.getLeftX();
+    this->rightX[this->count]  = box.getRightX();
+    this->count++;
+}
+
+/* -- Batched intersection tests -- */
+
+template <typename B>
+uint64_t intersectBatch(const B& box, const BoxBatch& batch, vec2<int>* sides) {
+    return intersectBatch(
+        box.getTopY(),
+        box.getBottomY(),
+        box.getLeftX(),
+        box.getRightX(),
+        batch,
+        sides
+    );
+}
+
+inline int lowestBit(uint64_t mask) {
+#if defined(__GNUC__)
+    return __builtin_ctzll(mask);
+#else
+    int index = 0;
+
+    while ((mask & 1) == 0) {
+        mask >>= 1;
+        index++;
+    }
+
+    return index;
+#endif
+}
+
+inline int countBits(uint64_t mask) {
+#if defined(__GNUC__)
+    return __builtin_popcountll(mask);
+#else
+    int count = 0;
+
+    while (mask != 0) {
+        mask &= mask - 1;
+        count++;
+    }
+
+    return count;
+#endif
+}
@@ -3,6 +3,8 @@
 #include <SDL2/SDL.h>
 #include <array>
 
+#include "input.hpp"
+#include "preferences.hpp"
 #include "util.hpp"
 
 using std::array;
@@ -13,6 +15,22 @@ vec2<int> mouseScreenPos;
 
 SDL_Event event;
 
+TickInput readTickInput() {
+    TickInput input;
+
+    if (keyStates[BT_LEFT])  input.buttons |= INPUT_LEFT;
+    if (keyStates[BT_RIGHT]) input.buttons |= INPUT_RIGHT;
+    if (keyStates[BT_UP])    input.buttons |= INPUT_UP;
+    if (keyStates[BT_DOWN])  input.buttons |= INPUT_DOWN;
+
+    if (mouseStates[SDL_BUTTON_LEFT]) input.buttons |= INPUT_FIRE;
+
+    input.aimX = mouseScreenPos.x;
+    input.aimY = mouseScreenPos.y;
+
+    return input;
+}
+
 bool doEvents() {
     while (SDL_PollEvent(&event) != 0) {
         switch (event.type) {
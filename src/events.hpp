@@ -6,6 +6,7 @@
 #include <SDL2/SDL.h>
 #include <array>
 
+#include "input.hpp"
 #include "util.hpp"
 
 using std::array;
@@ -21,6 +22,10 @@ extern array<bool, 5> mouseStates;
 // The current X and Y position of the mouse cursor on the screen
 extern vec2<int> mouseScreenPos;
 
+// The player's input for the current tick, read from keyStates, mouseStates
+// and mouseScreenPos
+extern TickInput readTickInput();
+
 // Event loop
 // Returns false when the window should close
 extern bool doEvents();
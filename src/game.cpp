@@ -1,4 +1,3 @@
-//TODO: scale trees' bounds with currently loaded level
 //TODO: proper ground collision
 //TODO: level editor
 //TODO: handle tile collisions in different ways for each side
@@ -7,6 +6,7 @@
 
 #include <SDL2/SDL.h>
 #include <cmath>
+#include <fstream>
 #include <iostream>
 #include <iomanip>
 #include <string>
@@ -14,220 +14,97 @@
 
 #include "events.hpp"
 #include "graphics.hpp"
+#include "input.hpp"
 #include "levels.hpp"
+#include "metrics.hpp"
 #include "objects.hpp"
 #include "preferences.hpp"
-#include "quadtree.hpp"
-#include "tiles.hpp"
+#include "profiler.hpp"
 #include "util.hpp"
+#include "world.hpp"
 
-using std::abs, std::min;
 using std::cout, std::endl;
 using std::setw;
 using std::string;
 using std::vector;
 
-// Usage: speedY += speedY*GRAV_MULT + GRAV_ADD
-const double GRAV_ADD = 0.3;
-const double GRAV_MULT = 0.03;
-const double GRAV_CAP = 15;
-
-// Loads the specified level from levelsTable
-Level* loadLevel(string levelName);
-
-// Kills the object of the specified index, removing it from gameObjects
-void killGameObject(int index);
-
-// Clears and repopulates gameObjectsTree
-void rebuildGameObjectsTree();
-
 // Sends debug info to standard output, based on the value of debugMode
 void printDebugInfo();
 
 int gameState = GS_LAUNCHED;
 
+World world;
+
 int    debugMode = 0;
 double debugOutputTimer = 0; // Used for delaying std::cout
 
-Player* player;
-Level*  loadedLevel; // Receives a value upon calling loadLevel
-
-vector<GameObject*> gameObjects = {};
+string gameLevel = "test";
 
-QuadTree<GameObject>* gameObjectsTree = new QuadTree<GameObject>(
-    0,
-    AABB(
-        {WINDOW_WIDTH/2, WINDOW_HEIGHT/2},
-        (WINDOW_WIDTH/2) - 2,
-        (WINDOW_HEIGHT/2) - 2
-    )
-);
+Player* player;
 
-QuadTree<Tile>* tilesTree = new QuadTree<Tile>(
-    0,
-    AABB(
-        {WINDOW_WIDTH/2, WINDOW_HEIGHT/2},
-        (WINDOW_WIDTH/2) - 2,
-        (WINDOW_HEIGHT/2) - 2
-    )
-);
+InputRecorder inputRecorder;
+InputReplay   inputReplay;
 
-array<bool, 5> mouseStatesTap = {false}; // Stores previous frame's mouseStates
+std::ofstream metricsFile; // Opened once DEBUG_METRICS first writes to it
 
 void doGame() {
 switch (gameState) {
 case GS_LAUNCHED:
     // Load level
-    loadedLevel = loadLevel("test");
-
-    for (Tile& tile : loadedLevel->getTiles()) {
-        tilesTree->insert(&tile);
+    // Levels are read from files, which may be missing, so the game can't go
+    // on without one
+    if (world.loadLevel(gameLevel) == nullptr) {
+        cout << "ERROR: Level \"" << gameLevel << "\" doesn't exist in " << world.levelsDirectory << '\n';
+        gameState = GS_FAILED;
+        break;
     }
 
     // Spawn player
-    player = new Player(
+    player = world.playerPool.create(
+        world.physics,
         WINDOW_WIDTH/2,
         WINDOW_HEIGHT/2
     );
-    gameObjects.push_back(player);
+    world.addGameObject(player);
 
     gameState = GS_STARTED;
     break;
 case GS_STARTED:
     /* -- Player input handling -- */
 
-    // Walking
-    if (keyStates[BT_LEFT]
-    && !keyStates[BT_RIGHT]) {
-        player->setState("walk");
-        player->walk(DIR_LEFT);
-    } else if (keyStates[BT_RIGHT]
-           && !keyStates[BT_LEFT]) {
-        player->setState("walk");
-        player->walk(DIR_RIGHT);
-    } else if (player->getState() == "walk") {
-        player->setSpeedX(0);
-        player->setState("stand");
-    }
-
-    // Have the player aim at and face the cursor
-    player->aimAt({
-        static_cast<double>(mouseScreenPos.x),
-        static_cast<double>(mouseScreenPos.y)
-    });
-
-    if (mouseScreenPos.x < player->getScreenX()) {
-        player->setDirection(DIR_LEFT);
-    } else if (mouseScreenPos.x > player->getScreenX()) {
-        player->setDirection(DIR_RIGHT);
-    }
-
-    //TEMP: fire projectiles with M1
-    if (mouseStates[SDL_BUTTON_LEFT]
-    && !mouseStatesTap[SDL_BUTTON_LEFT]) {
-        Projectile* proj = new Projectile(player, 90, 15, 15);
-        proj->teleport(
-            player->getAimX(),
-            player->getAimY()
-        );
-        proj->setWeight(0.85);
-        proj->thrust(
-            14 * player->getAimDirection().x,
-            14 * player->getAimDirection().y
-        );
+    {
+        TickInput input;
 
-        gameObjects.push_back(proj);
-    }
-
-    /* -- Physics -- */
-
-    rebuildGameObjectsTree();
-
-    // The loop below sometimes requires the GameObject's index in gameObjects,
-    // so a forEach can't be used
-    // There's also a chance the object will be killed and removed from
-    // gameObjects, in which case the iterator should not increment
-    int i = 0;
-
-    while (i < gameObjects.size()) {
-        GameObject* gobj = gameObjects[i]; // For convenience
-
-        // Apply gravity to objects
-        auto newSpeedY = (abs(gobj->getSpeedY())*GRAV_MULT + GRAV_ADD)*gobj->getWeight();
-
-        gobj->thrust(
-            0,
-            newSpeedY
-        );
-
-        // Cap falling speed
-        gobj->setSpeedY(min(gobj->getSpeedY(), GRAV_CAP*gobj->getWeight()));
-
-        // Displace game objects based on their speed
-        double targetX = gobj->getX() + gobj->getSpeedX();
-        double targetY = gobj->getY() + gobj->getSpeedY();
-
-        gobj->tryMove(targetX, targetY);
-
-        // Run the object's specific logic for this tick
-        gobj->tick();
-
-        // Kill object if it's out of health
-        if (gobj->getHealth() <= 0) {
-            killGameObject(i);
-            continue;
+        if (!inputReplay.isOpen()) {
+            input = readTickInput();
+        } else if (!inputReplay.next(input)) {
+            gameState = GS_FINISHED;
+            break;
         }
 
-        i++;
+        inputRecorder.record(input);
+        world.applyPlayerInput(player, input);
     }
 
-    /* -- Collision -- */
-
-    rebuildGameObjectsTree();
+    /* -- Physics and collision -- */
 
-    for (GameObject* gobj : gameObjects) {
-        while (true) {
-            // Whether or not the gobj collided with something
-            bool collision = false;
+    world.step();
 
-            // Find all tiles that could possibly be colliding with this object
-            vector<Tile*> possibleCols;
-            possibleCols = tilesTree->findPossibleCollisions(gobj->getBounds());
-
-            for (Tile* possibleCol : possibleCols) {
-                // Will be {0, 0} if not colliding
-                vec2<int> intersection = gobj->getBounds().intersects(
-                                             possibleCol->getBounds()
-                                         );
-
-                if (intersection != INTERSECT_NONE) {
-                    gobj->onCollideTile(possibleCol, intersection);
-                    collision = true;
-                    break;
-                }
-            }
-
-            if (collision) {
-                // The gobj may have changed position, so rebuild the tree
-                rebuildGameObjectsTree();
-
-                // Re-do all the collision checks
-                continue;
-            }
-
-            break;
+    if (debugMode & DEBUG_METRICS) {
+        if (!metricsFile.is_open()) {
+            metricsFile.open(METRICS_PATH);
+            writeCountersHeader(metricsFile);
         }
-    }
 
-    /* -- Other -- */
-
-    mouseStatesTap = mouseStates;
+        writeCountersRow(metricsFile, world.ticks);
+    }
 
     /* -- Debug -- */
 
     // Show debug info if enabled
+    // Counted in simulated time, as this may run several times per frame
     if (debugMode) {
-        debugOutputTimer += dt;
+        debugOutputTimer += STEP_LENGTH;
 
         if (debugOutputTimer >= 1) {
             printDebugInfo();
@@ -235,55 +112,35 @@ case GS_STARTED:
         }
     }
 
+    break;
+case GS_FINISHED:
+case GS_FAILED:
     break;
 }
 }
 
-Level* loadLevel(string levelName) {
-    try {
-        Level levelToCopy = levelsTable.at(levelName);
-
-        Level* copiedLevel = new Level(
-            levelToCopy.getDisplayName(),
-            levelToCopy.getTiles()
-        );
-
-        return copiedLevel;
-    } catch (std::out_of_range e) {
-        if (debugMode) {
-            cout << "ERROR: Attempted to load level that doesn't exist" << '\n';
-        }
-
-        return nullptr;
-    }
-}
-
-void killGameObject(int index) {
-    delete(gameObjects[index]);
-    gameObjects.erase(gameObjects.begin() + index);
-}
-
-void rebuildGameObjectsTree() {
-    gameObjectsTree->clear();
-
-    for (GameObject* gobj : gameObjects) {
-        gameObjectsTree->insert(gobj);
-    }
-
-    if (debugMode & DEBUG_SUBTICK_RENDERS) {
-        doRender();
-    }
-}
-
 void printDebugInfo() {
     if (debugMode & DEBUG_PERFORMANCE_INFO) {
+        int frames = framePacer.getFrameCount();
+
         cout << setw(10) << "fps="        << setw(16) << static_cast<int>(60/dt) << '\n'
+             << setw(10) << "workms="     << setw(16) << ((frames > 0) ? framePacer.getWorkTime()*1000/frames : 0) << '\n'
+             << setw(10) << "idlems="     << setw(16) << ((frames > 0) ? framePacer.getIdleTime()*1000/frames : 0) << '\n'
+             << setw(10) << "idle%="      << setw(16) << static_cast<int>(framePacer.getIdleRatio()*100) << '\n'
              << '\n';
+
+        framePacer.resetStats();
     }
     if (debugMode & DEBUG_LEVEL_INFO) {
-        cout << setw(10) << "lvlname="    << setw(16) << loadedLevel->getDisplayName() << '\n'
+        cout << setw(10) << "lvlname="    << setw(16) << world.level->getDisplayName() << '\n'
+             << setw(10) << "tiles="      << setw(16) << world.level->getTiles().size() << '\n'
+             << setw(10) << "coltiles="   << setw(16) << world.level->getCollisionTiles().size() << '\n'
              << '\n';
     }
+    if (debugMode & DEBUG_METRICS) {
+        printCounters(cout);
+        cout << '\n';
+    }
     if (debugMode & DEBUG_PLAYER_INFO) {
         cout << setw(10) << "x="          << setw(16) << player->getX() << '\n'
              << setw(10) << "y="          << setw(16) << player->getY() << '\n'
@@ -3,55 +3,73 @@
 #ifndef GAME_HPP
 #define GAME_HPP
 
-#include <vector>
+#include <string>
 
-#include "levels.hpp"
+#include "input.hpp"
 #include "objects.hpp"
-#include "quadtree.hpp"
-#include "tiles.hpp"
+#include "pacer.hpp"
+#include "world.hpp"
 
-using std::vector;
+using std::string;
 
 // Possible game states
 const int GS_LAUNCHED = 0;
 const int GS_STARTED = 1;
+const int GS_FINISHED = 2; // inputReplay has run out of input
+const int GS_FAILED = 3;   // The level couldn't be loaded
 
 // Flags for use with debugMode
-const int DEBUG_CONFIGS          = 0b0000001;
-const int DEBUG_PERFORMANCE_INFO = 0b0000010;
-const int DEBUG_LEVEL_INFO       = 0b0000100;
-const int DEBUG_PLAYER_INFO      = 0b0001000;
-const int DEBUG_SHOW_HITBOXES    = 0b0010000;
-const int DEBUG_SHOW_QUADS       = 0b0100000;
-const int DEBUG_SUBTICK_RENDERS  = 0b1000000;
+const int DEBUG_CONFIGS          = 0b000000001;
+const int DEBUG_PERFORMANCE_INFO = 0b000000010;
+const int DEBUG_LEVEL_INFO       = 0b000000100;
+const int DEBUG_PLAYER_INFO      = 0b000001000;
+const int DEBUG_SHOW_HITBOXES    = 0b000010000;
+const int DEBUG_SHOW_QUADS       = 0b000100000;
+const int DEBUG_SUBTICK_RENDERS  = 0b001000000;
+const int DEBUG_PROFILE          = 0b010000000; // Writes PROFILE_TRACE_PATH
+const int DEBUG_METRICS          = 0b100000000; // Writes METRICS_PATH
+
+// Where the profiler's trace is written on exit, when DEBUG_PROFILE is set
+const string PROFILE_TRACE_PATH = "profile.json";
+
+// Where the counters are written every tick, when DEBUG_METRICS is set
+const string METRICS_PATH = "metrics.csv";
 
 // Enables debug features
 // To be used with DEBUG_* flags
 extern int debugMode;
 
-// Delta time, measured in 60ths of a second
-// Should be capped at 1
+// Max. times doGame() can be called to catch up within a single frame
+const int MAX_STEPS_PER_FRAME = 5;
+
+// Time simulated by each call to doGame(), in 60ths of a second
+const double STEP_LENGTH = 1;
+
+// Delta time since the last frame, measured in 60ths of a second
+// Each call to doGame() simulates STEP_LENGTH of it instead, regardless of dt
 extern double dt;
 
+// Limits the frame rate of the main loop
+extern FramePacer framePacer;
+
 // The current game state, uses GS_* constants
 extern int gameState;
 
-// Points to currently loaded level
-extern Level* loadedLevel;
+// The world the game is played in
+extern World world;
 
-// The objects currently present in the game
-extern vector<GameObject*> gameObjects;
+// The level loaded into world once the game is launched
+extern string gameLevel;
 
-// Tree structure containing pointers to the bounding boxes of all objects
-// currently in-game
-extern QuadTree<GameObject>* gameObjectsTree;
+// The player object in world's gameObjects
+extern Player* player;
 
-// Tree structure containing pointers to the bounding boxes of all level tiles
-// currently loaded
-extern QuadTree<Tile>* tilesTree;
+// Records the input of every tick, once opened
+extern InputRecorder inputRecorder;
 
-// The player object in gameObjects
-extern Player* player;
+// Once opened, the input of every tick is read from here instead of from the
+// keyboard and mouse
+extern InputReplay inputReplay;
 
 // Processes game logic for a frame
 extern void doGame();
@@ -6,20 +6,27 @@
 #include <cmath>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "events.hpp"
 #include "game.hpp"
 #include "tiles.hpp"
+#include "tilestream.hpp"
 #include "quadtree.hpp"
 #include "util.hpp"
+#include "window.hpp"
 
 using std::abs, std::max;
 using std::string;
 using std::unordered_map;
+using std::vector;
 
-// Recursively draw a QuadTree
+// Recursively draw a QuadTree, starting from the node of the given index
 template <typename T>
-void drawTree(QuadTree<T>* tree, Uint32 color);
+void drawTree(QuadTree<T>* tree, int index, Uint32 color);
+
+// Draw the given tiles, according to debugMode
+void drawTiles(vector<Tile>& tiles);
 
 // Used for rendering game objects as solid rectangles in debug mode
 // X and Y refer to screen position rather than game position
@@ -42,26 +49,29 @@ void doRender() {
     // Clear screen before drawing
     SDL_FillRect(gameSurface, NULL, debugColors["background"]);
 
-    for (Tile& tile : loadedLevel->getTiles()) {
-        if (debugMode & DEBUG_SHOW_HITBOXES) {
-            /* -- Draw tile collision boxes -- */
-
-            rendererRect.w = tile.getWidth();
-            rendererRect.h = tile.getHeight();
-            rendererRect.x = tile.getX();
-            rendererRect.y = tile.getY();
+    // Nothing's loaded before the first tick
+    if (world.level != nullptr && gameState != GS_LAUNCHED) {
+        drawTiles(world.level->getTiles());
+    }
 
-            SDL_FillRect(gameSurface, &rendererRect, debugColors["tile"]);
+    // Streamed levels only have the tiles of the chunks around the player
+    if (world.tilesStream != nullptr) {
+        for (StreamingTileIndex::Chunk* chunk : world.tilesStream->getActiveChunks()) {
+            if (chunk != nullptr) drawTiles(chunk->level.getTiles());
         }
     }
 
     if (debugMode & DEBUG_SHOW_QUADS) {
         // Show boundaries of the collision trees
-        drawTree(tilesTree, debugColors["tile_tree"]);
-        drawTree(gameObjectsTree, debugColors["obj_tree"]);
+        // tilesTree is only populated when it's used for collision checks
+        if (world.tileQueryMode == TILE_QUERY_TREE) {
+            drawTree(world.tilesTree, 0, debugColors["tile_tree"]);
+        }
+
+        drawTree(world.gameObjectsTree, 0, debugColors["obj_tree"]);
     }
 
-    for (GameObject* gobj : gameObjects) {
+    for (GameObject* gobj : world.gameObjects) {
         if (!gobj->isVisible()) return;
 
         if (debugMode & DEBUG_SHOW_HITBOXES) {
@@ -81,8 +91,8 @@ void doRender() {
             rendererRect.h = 1;
     
             // The starting point of the line (object's center)
-            int centerX = gobj->getX() - rendererRect.w/2;
-            int centerY = gobj->getY() - rendererRect.h/2;
+            int centerX = gobj->getScreenX() - rendererRect.w/2;
+            int centerY = gobj->getScreenY() - rendererRect.h/2;
     
             // The ending point of the line (a few units in its direction)
             int targetX = centerX + (gobj->getDirection().x * 25);
@@ -153,23 +163,37 @@ void drawRectangle(SDL_Surface* surface, SDL_Rect& rendererRect, Uint32 color, i
 }
 
 template <typename T>
-void drawTree(QuadTree<T>* tree, Uint32 color) {
+void drawTree(QuadTree<T>* tree, int index, Uint32 color) {
     rendererRect.w = 1;
     rendererRect.h = 1;
 
-    AABB& bounds = tree->getBounds();
+    auto& node = tree->getNode(index);
 
     drawRectangle(
         gameSurface, rendererRect, color,
-        bounds.center.x - bounds.halfWidth,
-        bounds.center.y - bounds.halfHeight,
-        bounds.center.x + bounds.halfWidth,
-        bounds.center.y + bounds.halfHeight
+        node.bounds.center.x - node.bounds.halfWidth,
+        node.bounds.center.y - node.bounds.halfHeight,
+        node.bounds.center.x + node.bounds.halfWidth,
+        node.bounds.center.y + node.bounds.halfHeight
     );
 
-    if (tree->getQuadrants()[0] != nullptr) {
-        for (QuadTree<T>* quad : tree->getQuadrants()) {
-            drawTree(quad, color);
+    if (node.firstQuad != -1) {
+        for (int i = 0; i < 4; i++) {
+            drawTree(tree, node.firstQuad + i, color);
         }
     }
-}
\ No newline at end of file
+}
+void drawTiles(vector<Tile>& tiles) {
+    if (!(debugMode & DEBUG_SHOW_HITBOXES)) return;
+
+    /* -- Draw tile collision boxes -- */
+
+    for (Tile& tile : tiles) {
+        rendererRect.w = tile.getWidth();
+        rendererRect.h = tile.getHeight();
+        rendererRect.x = tile.getX();
+        rendererRect.y = tile.getY();
+
+        SDL_FillRect(gameSurface, &rendererRect, debugColors["tile"]);
+    }
+}
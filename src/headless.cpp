@@ -0,0 +1,266 @@
+// Steps the simulation as fast as possible without opening a window
+// Usage: 2d-physics-headless [--levels <dir>] [ticks] [projectiles] [level]
+//        2d-physics-headless [--levels <dir>] --replay <file> [level]
+//        2d-physics-headless [--levels <dir>] --worlds <count> [ticks] [projectiles] [threads] [level]
+// Replays play back input recorded by the game, one tick per input, on the
+// level it was recorded on, which level must match if it's given
+// --worlds steps that many separate worlds in parallel, one thread per core
+// unless threads is given
+// Levels are read from the directory the build generated them in, unless
+// --levels is given
+
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "input.hpp"
+#include "objects.hpp"
+#include "runner.hpp"
+#include "util.hpp"
+#include "world.hpp"
+
+using std::cout, std::cerr;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+// Printed with --help, or when the arguments aren't valid
+const char USAGE[] =
+    "Usage: 2d-physics-headless [--levels <dir>] [ticks] [projectiles] [level]\n"
+    "       2d-physics-headless [--levels <dir>] --replay <file> [level]\n"
+    "       2d-physics-headless [--levels <dir>] --worlds <count> [ticks] [projectiles] [threads] [level]\n";
+
+// Directory which every world loads its level from
+string levelsDirectory = LEVELS_DIRECTORY;
+
+// Parses a whole argument as an int which is at least minimum
+// Returns false if it isn't one, in which case value is left untouched
+bool parseInt(const char* arg, int minimum, int& value);
+
+// Loads a level into the world from levelsDirectory, then spawns the player
+// and the given number of projectiles
+// variant shifts the projectiles around, so that separate worlds don't all
+// simulate the exact same thing
+// Returns nullptr if the level doesn't exist
+Player* populate(World& world, string levelName, int projectiles, int variant = 0);
+
+// Prints how long it took to simulate the given number of ticks
+void printResults(World& world, int ticks, double seconds);
+
+// Plays back a recording of the player's input, as fast as possible
+// Fails if levelName isn't empty and isn't the level it was recorded on
+int replay(string path, string levelName);
+
+// Steps many worlds at once, reporting the total ticks per second
+int runWorlds(int worldCount, int ticks, int projectiles, int threads, string levelName);
+
+int main(int argc, char** argv) {
+    // Skipped over once read, so that the other arguments keep their position
+    if (argc > 2 && string(argv[1]) == "--levels") {
+        levelsDirectory = argv[2];
+        argc -= 2;
+        argv += 2;
+    }
+
+    string mode = (argc > 1) ? argv[1] : "";
+
+    if (mode == "--help" || mode == "-h") {
+        cout << USAGE;
+        return 0;
+    }
+
+    if (mode == "--replay") {
+        if (argc < 3 || argc > 4) {
+            cerr << USAGE;
+            return 1;
+        }
+
+        return replay(argv[2], (argc > 3) ? argv[3] : "");
+    }
+
+    if (mode == "--worlds") {
+        int worldCount  = 0;
+        int ticks       = 1000;
+        int projectiles = 100;
+        int threads     = 0; // One per core
+
+        if (argc < 3 || argc > 7
+        ||  !parseInt(argv[2], 1, worldCount)
+        ||  (argc > 3 && !parseInt(argv[3], 1, ticks))
+        ||  (argc > 4 && !parseInt(argv[4], 0, projectiles))
+        ||  (argc > 5 && !parseInt(argv[5], 0, threads))) {
+            cerr << USAGE;
+            return 1;
+        }
+
+        return runWorlds(worldCount, ticks, projectiles, threads, (argc > 6) ? argv[6] : "test");
+    }
+
+    int    ticks       = 10000;
+    int    projectiles = 100;
+    string levelName   = (argc > 3) ? argv[3] : "test";
+
+    if (argc > 4
+    ||  (argc > 1 && !parseInt(argv[1], 1, ticks))
+    ||  (argc > 2 && !parseInt(argv[2], 0, projectiles))) {
+        cerr << USAGE;
+        return 1;
+    }
+
+    World world;
+
+    if (populate(world, levelName, projectiles) == nullptr) {
+        cerr << "ERROR: Level \"" << levelName << "\" doesn't exist in " << levelsDirectory << '\n';
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < ticks; i++) {
+        world.step();
+    }
+
+    double seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start
+                     ).count();
+
+    printResults(world, ticks, seconds);
+
+    return 0;
+}
+
+bool parseInt(const char* arg, int minimum, int& value) {
+    size_t length = 0;
+    int    parsed;
+
+    try {
+        parsed = std::stoi(arg, &length);
+    } catch (const std::logic_error&) {
+        // Not a number, or out of range
+        return false;
+    }
+
+    if (arg[length] != '\0' || parsed < minimum) return false;
+
+    value = parsed;
+    return true;
+}
+
+Player* populate(World& world, string levelName, int projectiles, int variant) {
+    world.levelsDirectory = levelsDirectory;
+
+    if (world.loadLevel(levelName) == nullptr) return nullptr;
+
+    Player* player = world.playerPool.create(world.physics, WINDOW_WIDTH/2, WINDOW_HEIGHT/2);
+    world.addGameObject(player);
+
+    // Spread projectiles over the top half of the window, thrown in a spread
+    // of directions so that they keep colliding with tiles and each other's
+    // tree nodes
+    for (int i = 0; i < projectiles; i++) {
+        Projectile* proj = world.projectilePool.create(world.physics, world.playerPool, nullptr, -1, 15, 15);
+        int         j    = i + variant*7;
+
+        proj->teleport(
+            16 + (j*37) % (WINDOW_WIDTH - 32),
+            16 + (j*53) % (WINDOW_HEIGHT/2)
+        );
+        proj->thrust((j % 21) - 10, -(j % 13));
+
+        world.addGameObject(proj);
+    }
+
+    return player;
+}
+
+int replay(string path, string levelName) {
+    InputReplay inputs;
+
+    if (!inputs.open(path)) {
+        cerr << "ERROR: Couldn't read input replay " << path << '\n';
+        return 1;
+    }
+
+    // The player is spawned the same way as in the game, and the world uses
+    // the level and settings it was recorded with, so that the recording
+    // plays out identically
+    if (!levelName.empty() && levelName != inputs.getLevelName()) {
+        cerr << "ERROR: Input replay " << path << " was recorded on level \""
+             << inputs.getLevelName() << "\", not \"" << levelName << "\"\n";
+        return 1;
+    }
+
+    levelName = inputs.getLevelName();
+
+    World world;
+    world.tileQueryMode   = inputs.getTileQueryMode();
+    world.mergeLevelTiles = inputs.getMergeLevelTiles();
+
+    Player* player = populate(world, levelName, 0);
+
+    if (player == nullptr) {
+        cerr << "ERROR: Level \"" << levelName << "\" doesn't exist in " << levelsDirectory << '\n';
+        return 1;
+    }
+
+    TickInput input;
+    int       ticks = 0;
+
+    auto start = std::chrono::steady_clock::now();
+
+    while (inputs.next(input)) {
+        world.applyPlayerInput(player, input);
+        world.step();
+        ticks++;
+    }
+
+    double seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start
+                     ).count();
+
+    printResults(world, ticks, seconds);
+
+    cout << "playerx=" << player->getX() << '\n'
+         << "playery=" << player->getY() << '\n';
+
+    return 0;
+}
+
+int runWorlds(int worldCount, int ticks, int projectiles, int threads, string levelName) {
+    vector<unique_ptr<World>> worlds;
+    vector<World*>            batch;
+
+    for (int i = 0; i < worldCount; i++) {
+        worlds.emplace_back(new World());
+
+        if (populate(*worlds.back(), levelName, projectiles, i) == nullptr) {
+            cerr << "ERROR: Level \"" << levelName << "\" doesn't exist in " << levelsDirectory << '\n';
+            return 1;
+        }
+
+        batch.push_back(worlds.back().get());
+    }
+
+    WorldRunner runner(threads);
+
+    double seconds = runner.run(batch, ticks);
+
+    cout << "worlds="        << worldCount << '\n'
+         << "threads="       << runner.getThreadCount() << '\n'
+         << "ticks="         << ticks << '\n'
+         << "seconds="       << seconds << '\n'
+         << "world-ticks/s=" << worldCount*static_cast<double>(ticks)/seconds << '\n';
+
+    return 0;
+}
+
+void printResults(World& world, int ticks, double seconds) {
+    cout << "ticks="   << ticks << '\n'
+         << "objects=" << world.gameObjects.size() << '\n'
+         << "seconds=" << seconds << '\n'
+         << "ticks/s=" << ticks/seconds << '\n';
+}
@@ -0,0 +1,174 @@
+#include "input.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#include "levelfile.hpp"
+#include "tilequery.hpp"
+
+// Write/read integers byte by byte, so that files don't depend on the
+// machine's endianness
+static void writeU16(std::ofstream& file, uint16_t value) {
+    char bytes[2] = {
+        static_cast<char>(value & 0xFF),
+        static_cast<char>(value >> 8)
+    };
+
+    file.write(bytes, 2);
+}
+static bool readU16(std::ifstream& file, uint16_t& value) {
+    unsigned char bytes[2];
+
+    if (!file.read(reinterpret_cast<char*>(bytes), 2)) return false;
+
+    value = bytes[0] | (bytes[1] << 8);
+    return true;
+}
+
+/* -- TickInput -- */
+
+bool TickInput::operator==(const TickInput& other) const {
+    return this->buttons == other.buttons
+        && this->aimX    == other.aimX
+        && this->aimY    == other.aimY;
+}
+bool TickInput::operator!=(const TickInput& other) const {
+    return !(*this == other);
+}
+
+/* -- InputRecorder -- */
+
+// Destructors
+InputRecorder::~InputRecorder() {
+    this->close();
+}
+
+// Getters
+bool InputRecorder::isOpen() const { return this->file.is_open(); }
+
+// Other methods
+bool InputRecorder::open(string path, string levelName, int tileQueryMode, bool mergeLevelTiles) {
+    this->close();
+
+    // Its length is stored in a single byte
+    if (!isValidLevelName(levelName) || levelName.size() > UINT8_MAX) return false;
+
+    this->file.open(path, std::ios::binary | std::ios::trunc);
+
+    if (!this->file) return false;
+
+    this->file.write(INPUT_FILE_MAGIC, sizeof(INPUT_FILE_MAGIC));
+    writeU16(this->file, INPUT_FILE_VERSION);
+    this->file.put(static_cast<char>(tileQueryMode));
+    this->file.put(static_cast<char>(mergeLevelTiles));
+    this->file.put(static_cast<char>(levelName.size()));
+    this->file.write(levelName.data(), levelName.size());
+
+    this->runLength = 0;
+    return true;
+}
+
+void InputRecorder::writeRun() {
+    if (this->runLength == 0) return;
+
+    writeU16(this->file, this->runLength);
+    this->file.put(static_cast<char>(this->runInput.buttons));
+    writeU16(this->file, static_cast<uint16_t>(this->runInput.aimX));
+    writeU16(this->file, static_cast<uint16_t>(this->runInput.aimY));
+
+    this->runLength = 0;
+}
+
+void InputRecorder::record(const TickInput& input) {
+    if (!this->file.is_open()) return;
+
+    if (this->runLength > 0
+    && (input != this->runInput || this->runLength == UINT16_MAX)) {
+        this->writeRun();
+    }
+
+    this->runInput = input;
+    this->runLength++;
+}
+
+void InputRecorder::close() {
+    if (!this->file.is_open()) return;
+
+    this->writeRun();
+    this->file.close();
+}
+
+/* -- InputReplay -- */
+
+// Getters
+bool   InputReplay::isOpen() const             { return this->file.is_open(); }
+string InputReplay::getLevelName() const       { return this->levelName; }
+int    InputReplay::getTileQueryMode() const   { return this->tileQueryMode; }
+bool   InputReplay::getMergeLevelTiles() const { return this->mergeLevelTiles; }
+
+// Other methods
+bool InputReplay::open(string path) {
+    this->file.open(path, std::ios::binary);
+
+    char     magic[sizeof(INPUT_FILE_MAGIC)];
+    uint16_t version;
+    int      tileQueryMode, mergeLevelTiles, levelNameLength;
+    string   levelName;
+
+    if (!this->file.read(magic, sizeof(magic))
+    ||  memcmp(magic, INPUT_FILE_MAGIC, sizeof(magic)) != 0
+    ||  !readU16(this->file, version)
+    ||  version != INPUT_FILE_VERSION
+    ||  (tileQueryMode = this->file.get()) == EOF
+    ||  (mergeLevelTiles = this->file.get()) == EOF
+    ||  (levelNameLength = this->file.get()) == EOF
+    ||  tileQueryMode > TILE_QUERY_STREAM
+    ||  mergeLevelTiles > 1) {
+        this->file.close();
+        return false;
+    }
+
+    // The name is used as part of a path, so it mustn't be able to point
+    // outside of the levels directory
+    levelName.resize(levelNameLength);
+
+    if (!this->file.read(levelName.data(), levelNameLength)
+    ||  !isValidLevelName(levelName)) {
+        this->file.close();
+        return false;
+    }
+
+    this->levelName       = levelName;
+    this->tileQueryMode   = tileQueryMode;
+    this->mergeLevelTiles = mergeLevelTiles;
+
+    this->runLeft = 0;
+    return true;
+}
+
+bool InputReplay::next(TickInput& input) {
+    if (this->runLeft == 0) {
+        uint16_t length, aimX, aimY;
+        int      buttons;
+
+        if (!readU16(this->file, length)
+        ||  (buttons = this->file.get()) == EOF
+        ||  !readU16(this->file, aimX)
+        ||  !readU16(this->file, aimY)
+        ||  length == 0) {
+            return false;
+        }
+
+        this->runInput.buttons = buttons;
+        this->runInput.aimX = static_cast<int16_t>(aimX);
+        this->runInput.aimY = static_cast<int16_t>(aimY);
+        this->runLeft = length;
+    }
+
+    input = this->runInput;
+    this->runLeft--;
+
+    return true;
+}
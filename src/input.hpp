@@ -0,0 +1,106 @@
+// Player input for a single tick, and recording/replaying it to/from files
+
+#ifndef INPUT_HPP
+#define INPUT_HPP
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+using std::string;
+
+// Flags for use with TickInput::buttons
+const uint8_t INPUT_LEFT  = 0b00001;
+const uint8_t INPUT_RIGHT = 0b00010;
+const uint8_t INPUT_UP    = 0b00100;
+const uint8_t INPUT_DOWN  = 0b01000;
+const uint8_t INPUT_FIRE  = 0b10000;
+
+// Identifies input recordings, followed by INPUT_FILE_VERSION
+const char     INPUT_FILE_MAGIC[4] = {'P', 'G', 'I', 'N'};
+const uint16_t INPUT_FILE_VERSION  = 3;
+
+// Everything the simulation reads from the player's input in a tick
+struct TickInput {
+    uint8_t buttons = 0; // Uses INPUT_* flags
+    int16_t aimX    = 0; // Cursor position, in screen coordinates
+    int16_t aimY    = 0;
+
+    bool operator==(const TickInput& other) const;
+    bool operator!=(const TickInput& other) const;
+};
+
+/*
+ * Streams the input of every tick to a binary file
+ *
+ * The file starts with INPUT_FILE_MAGIC and INPUT_FILE_VERSION, then the
+ * World settings which change how the input plays out: tileQueryMode and
+ * mergeLevelTiles, a byte each, then the length of the level's name as a byte,
+ * followed by its characters. These are followed by runs of identical inputs:
+ * a 16-bit repeat count, then the input's buttons, aimX and aimY. All values
+ * are little-endian.
+ *
+ * Consecutive ticks usually have the same input, so a run is only written
+ * once the input changes, or once close() is called.
+ */
+class InputRecorder {
+    private:
+        std::ofstream file;
+        TickInput     runInput;
+        uint16_t      runLength = 0;
+
+        void writeRun();
+    public:
+        InputRecorder() = default;
+        InputRecorder(const InputRecorder&) = delete;
+        InputRecorder& operator=(const InputRecorder&) = delete;
+
+        // Writes the last run
+        ~InputRecorder();
+
+        // Start recording to a file, replacing it if it exists, along with
+        // the level and settings of the world the input is given to
+        // Returns false if the file couldn't be opened, or the level's name
+        // isn't valid (see isValidLevelName) or is over 255 characters long
+        bool open(string path, string levelName, int tileQueryMode, bool mergeLevelTiles);
+
+        bool isOpen() const;
+
+        // Add the input of the next tick
+        void record(const TickInput& input);
+
+        // Write the last run and close the file
+        void close();
+};
+
+// Reads back the inputs written by an InputRecorder, one tick at a time
+class InputReplay {
+    private:
+        std::ifstream file;
+        TickInput     runInput;
+        uint16_t      runLeft = 0; // Ticks left in the current run
+
+        // Level and World settings the input was recorded with
+        string levelName;
+        int    tileQueryMode   = 0;
+        bool   mergeLevelTiles = false;
+    public:
+        // Start replaying a file
+        // Returns false if the file couldn't be opened, or isn't an input
+        // recording of a supported version with a valid level name
+        bool open(string path);
+
+        bool isOpen() const;
+
+        // The recording only plays out the same on this level, in a world
+        // with these settings, so they should be applied before loading it
+        string getLevelName() const;
+        int    getTileQueryMode() const;
+        bool   getMergeLevelTiles() const;
+
+        // Read the input of the next tick
+        // Returns false once the recording has ended
+        bool next(TickInput& input);
+};
+
+#endif
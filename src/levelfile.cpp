@@ -0,0 +1,453 @@
+#include "levelfile.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "levels.hpp"
+#include "tileindex.hpp"
+#include "tiles.hpp"
+
+using std::map;
+using std::max, std::min;
+using std::pair;
+using std::string;
+using std::vector;
+
+// Largest chunk size accepted, in grid cells
+static const uint32_t MAX_CHUNK_SIZE = 1024;
+
+// Round an offset up to the alignment of every section
+static uint64_t alignSection(uint64_t offset) {
+    return (offset + 7) & ~uint64_t(7);
+}
+
+// Check that a section of count elements of the given size fits in the file
+static bool sectionFits(uint64_t offset, uint64_t count, uint64_t elementSize, size_t fileSize) {
+    return offset % 8 == 0
+        && offset <= fileSize
+        && count*elementSize <= fileSize - offset;
+}
+
+// Furthest a tile's edges can be from the origin, in grid cells, so that
+// they can still be converted to pixels as ints
+static const int64_t MAX_GRID_COORDINATE = INT_MAX / TILEGRID_CELL_SIZE;
+
+// Check that every tile has a known type, and a valid size and position
+static bool tilesValid(const LevelFileTile* tiles, int count, int typeCount) {
+    for (int i = 0; i < count; i++) {
+        const LevelFileTile& tile = tiles[i];
+
+        if (tile.typeId <= 0 || tile.typeId >= typeCount
+        ||  tile.gridWidth <= 0 || tile.gridHeight <= 0
+        ||  tile.gridX < -MAX_GRID_COORDINATE || tile.gridY < -MAX_GRID_COORDINATE
+        ||  int64_t(tile.gridX) + tile.gridWidth  > MAX_GRID_COORDINATE
+        ||  int64_t(tile.gridY) + tile.gridHeight > MAX_GRID_COORDINATE) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Divide, rounding towards negative infinity
+static int floorDivide(int value, int divisor) {
+    return (value >= 0) ? value/divisor : -((-value + divisor - 1)/divisor);
+}
+
+/* -- LevelFile -- */
+
+// Constructors
+LevelFile::LevelFile(string path) {
+#ifdef _WIN32
+    std::ifstream file(path, std::ios::binary);
+
+    if (!file) return;
+
+    this->buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    this->data = this->buffer.data();
+    this->size = this->buffer.size();
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+
+    if (fd < 0) return;
+
+    struct stat info;
+
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        void* mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (mapped != MAP_FAILED) {
+            this->data = static_cast<const uint8_t*>(mapped);
+            this->size = info.st_size;
+        }
+    }
+
+    // The mapping stays valid once the file is closed
+    close(fd);
+#endif
+
+    if (this->data == nullptr) return;
+
+    this->header = reinterpret_cast<const LevelFileHeader*>(this->data);
+
+    if (!this->validate()) {
+        this->header = nullptr;
+        this->unmap();
+    }
+}
+
+// Destructors
+LevelFile::~LevelFile() {
+    this->unmap();
+}
+
+// Getters
+bool LevelFile::isOpen() const   { return this->header != nullptr; }
+bool LevelFile::hasIndex() const { return this->header->indexBoxCount > 0; }
+
+string LevelFile::getDisplayName() const {
+    return string(
+        reinterpret_cast<const char*>(this->data + this->header->nameOffset),
+        this->header->nameLength
+    );
+}
+
+int LevelFile::getTileCount() const { return this->header->tileCount; }
+const LevelFileTile* LevelFile::getTiles() const {
+    return reinterpret_cast<const LevelFileTile*>(this->data + this->header->tilesOffset);
+}
+
+int LevelFile::getMergedCount() const { return this->header->mergedCount; }
+const LevelFileTile* LevelFile::getMergedTiles() const {
+    return reinterpret_cast<const LevelFileTile*>(this->data + this->header->mergedOffset);
+}
+
+int LevelFile::getChunkCount() const { return this->header->chunkCount; }
+int LevelFile::getChunkSize() const  { return this->header->chunkSize; }
+const LevelFileChunk* LevelFile::getChunks() const {
+    return reinterpret_cast<const LevelFileChunk*>(this->data + this->header->chunksOffset);
+}
+const LevelFileTile* LevelFile::getChunkTiles() const {
+    return reinterpret_cast<const LevelFileTile*>(this->data + this->header->chunkTilesOffset);
+}
+
+// Other methods
+bool LevelFile::validate() const {
+    const LevelFileHeader& header = *this->header;
+
+    if (this->size < sizeof(LevelFileHeader)
+    ||  memcmp(header.magic, LEVEL_FILE_MAGIC, sizeof(header.magic)) != 0
+    ||  header.version != LEVEL_FILE_VERSION) {
+        return false;
+    }
+
+    if (!sectionFits(header.nameOffset,        header.nameLength,      1,                               this->size)
+    ||  !sectionFits(header.typesOffset,       header.typeCount,       sizeof(LevelFileType),           this->size)
+    ||  !sectionFits(header.tilesOffset,       header.tileCount,       sizeof(LevelFileTile),           this->size)
+    ||  !sectionFits(header.mergedOffset,      header.mergedCount,     sizeof(LevelFileTile),           this->size)
+    ||  !sectionFits(header.indexBoxesOffset,  header.indexBoxCount,   sizeof(StaticTileIndex::Box),    this->size)
+    ||  !sectionFits(header.indexLevelsOffset, header.indexLevelCount, sizeof(int32_t),                 this->size)
+    ||  !sectionFits(header.chunksOffset,      header.chunkCount,      sizeof(LevelFileChunk),          this->size)
+    ||  !sectionFits(header.chunkTilesOffset,  header.chunkTileCount,  sizeof(LevelFileTile),           this->size)) {
+        return false;
+    }
+
+    // Tile types are only stored so that files can be checked against the
+    // types the game was compiled with
+    const LevelFileType* types = reinterpret_cast<const LevelFileType*>(this->data + header.typesOffset);
+
+    if (header.typeCount > TILE_TYPE_COUNT) return false;
+
+    for (uint32_t i = 1; i < header.typeCount; i++) {
+        if (types[i].gridWidth  != tileTypesTable[i].gridWidth
+        ||  types[i].gridHeight != tileTypesTable[i].gridHeight) {
+            return false;
+        }
+    }
+
+    if (!tilesValid(this->getTiles(), header.tileCount, header.typeCount)
+    ||  !tilesValid(this->getMergedTiles(), header.mergedCount, header.typeCount)
+    ||  !tilesValid(this->getChunkTiles(), header.chunkTileCount, header.typeCount)) {
+        return false;
+    }
+
+    if (header.indexBoxCount > 0) {
+        // The index must be over the collision tiles, and be shaped like one
+        // built by StaticTileIndex
+        const int32_t* levelEnds = reinterpret_cast<const int32_t*>(this->data + header.indexLevelsOffset);
+        uint32_t       leaves    = (header.mergedCount > 0) ? header.mergedCount : header.tileCount;
+
+        if (!StaticTileIndex::checkLevelEnds(levelEnds, header.indexLevelCount, header.indexBoxCount)
+        ||  static_cast<uint32_t>(levelEnds[0]) != leaves
+        ||  !sectionFits(header.indexOrderOffset, leaves, sizeof(uint32_t), this->size)) {
+            return false;
+        }
+
+        const uint32_t* order = reinterpret_cast<const uint32_t*>(this->data + header.indexOrderOffset);
+
+        for (uint32_t i = 0; i < leaves; i++) {
+            if (order[i] >= leaves) return false;
+        }
+    }
+
+    if (header.chunkCount > 0) {
+        // Chunks must be sorted so that findChunk() can search them, and
+        // only contain tiles within their own bounds
+        if (header.chunkSize == 0 || header.chunkSize > MAX_CHUNK_SIZE) return false;
+
+        const LevelFileChunk* chunks     = this->getChunks();
+        const LevelFileTile*  chunkTiles = this->getChunkTiles();
+
+        for (uint32_t i = 0; i < header.chunkCount; i++) {
+            const LevelFileChunk& chunk = chunks[i];
+
+            if (i > 0
+            &&  (chunks[i - 1].chunkY > chunk.chunkY
+            ||   (chunks[i - 1].chunkY == chunk.chunkY && chunks[i - 1].chunkX >= chunk.chunkX))) {
+                return false;
+            }
+
+            if (chunk.tileCount == 0
+            ||  chunk.firstTile > header.chunkTileCount
+            ||  chunk.tileCount > header.chunkTileCount - chunk.firstTile) {
+                return false;
+            }
+
+            int64_t left = int64_t(chunk.chunkX)*header.chunkSize;
+            int64_t top  = int64_t(chunk.chunkY)*header.chunkSize;
+
+            for (uint32_t j = chunk.firstTile; j < chunk.firstTile + chunk.tileCount; j++) {
+                const LevelFileTile& tile = chunkTiles[j];
+
+                if (tile.gridX < left || int64_t(tile.gridX) + tile.gridWidth  > left + header.chunkSize
+                ||  tile.gridY < top  || int64_t(tile.gridY) + tile.gridHeight > top + header.chunkSize) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+int LevelFile::findChunk(int chunkX, int chunkY) const {
+    const LevelFileChunk* first = this->getChunks();
+    const LevelFileChunk* last  = first + this->header->chunkCount;
+
+    const LevelFileChunk* found = std::lower_bound(first, last, pair<int, int>(chunkY, chunkX),
+        [](const LevelFileChunk& chunk, const pair<int, int>& position) {
+            return chunk.chunkY < position.first
+               || (chunk.chunkY == position.first && chunk.chunkX < position.second);
+        }
+    );
+
+    if (found == last || found->chunkX != chunkX || found->chunkY != chunkY) return -1;
+
+    return found - first;
+}
+
+void LevelFile::unmap() {
+#ifndef _WIN32
+    if (this->data != nullptr) {
+        munmap(const_cast<uint8_t*>(this->data), this->size);
+    }
+#endif
+
+    this->buffer.clear();
+    this->data = nullptr;
+    this->size = 0;
+}
+
+StaticTileIndex* LevelFile::createIndex(vector<Tile>& tiles) const {
+    const LevelFileHeader& header = *this->header;
+
+    return new StaticTileIndex(
+        tiles,
+        reinterpret_cast<const StaticTileIndex::Box*>(this->data + header.indexBoxesOffset),
+        header.indexBoxCount,
+        reinterpret_cast<const uint32_t*>(this->data + header.indexOrderOffset),
+        reinterpret_cast<const int32_t*>(this->data + header.indexLevelsOffset),
+        header.indexLevelCount
+    );
+}
+
+bool isValidLevelName(const string& levelName) {
+    if (levelName.empty()) return false;
+
+    for (char c : levelName) {
+        if (!(c >= 'a' && c <= 'z') && !(c >= 'A' && c <= 'Z')
+        &&  !(c >= '0' && c <= '9') && c != '_' && c != '-') {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool writeLevelFile(string path, Level& level, bool withIndex) {
+    string        name   = level.getDisplayName();
+    vector<Tile>& tiles  = level.getTiles();
+    vector<Tile>* merged = level.hasMergedTiles() ? &level.getCollisionTiles() : nullptr;
+
+    StaticTileIndex* index = withIndex ? new StaticTileIndex(level.getCollisionTiles()) : nullptr;
+
+    auto toRecord = [](Tile& tile) {
+        TileAABB& bounds = tile.getBounds();
+
+        return LevelFileTile{
+            bounds.typeId,
+            bounds.gridX,
+            bounds.gridY,
+            bounds.gridWidth,
+            bounds.gridHeight
+        };
+    };
+
+    /* -- Chunks -- */
+
+    // Tiles of each chunk, cut at its edges, sorted by chunkY then chunkX
+    map<pair<int, int>, vector<LevelFileTile>> chunkTiles;
+
+    for (Tile& tile : tiles) {
+        LevelFileTile record = toRecord(tile);
+
+        int firstX = floorDivide(record.gridX, LEVEL_CHUNK_SIZE);
+        int firstY = floorDivide(record.gridY, LEVEL_CHUNK_SIZE);
+        int lastX  = floorDivide(record.gridX + record.gridWidth - 1, LEVEL_CHUNK_SIZE);
+        int lastY  = floorDivide(record.gridY + record.gridHeight - 1, LEVEL_CHUNK_SIZE);
+
+        for (int chunkY = firstY; chunkY <= lastY; chunkY++) {
+            for (int chunkX = firstX; chunkX <= lastX; chunkX++) {
+                int left   = max(record.gridX, chunkX*LEVEL_CHUNK_SIZE);
+                int top    = max(record.gridY, chunkY*LEVEL_CHUNK_SIZE);
+                int right  = min(record.gridX + record.gridWidth, (chunkX + 1)*LEVEL_CHUNK_SIZE);
+                int bottom = min(record.gridY + record.gridHeight, (chunkY + 1)*LEVEL_CHUNK_SIZE);
+
+                chunkTiles[{chunkY, chunkX}].push_back(
+                    LevelFileTile{record.typeId, left, top, right - left, bottom - top}
+                );
+            }
+        }
+    }
+
+    /* -- Layout -- */
+
+    LevelFileHeader header = {};
+    memcpy(header.magic, LEVEL_FILE_MAGIC, sizeof(header.magic));
+    header.version     = LEVEL_FILE_VERSION;
+    header.nameLength  = name.size();
+    header.typeCount   = TILE_TYPE_COUNT;
+    header.tileCount   = tiles.size();
+    header.mergedCount = (merged != nullptr) ? merged->size() : 0;
+
+    if (index != nullptr && index->getBoxCount() > 0) {
+        header.indexBoxCount   = index->getBoxCount();
+        header.indexLevelCount = index->getLevelEnds().size();
+    }
+
+    header.chunkSize  = LEVEL_CHUNK_SIZE;
+    header.chunkCount = chunkTiles.size();
+
+    for (auto& [position, chunk] : chunkTiles) {
+        header.chunkTileCount += chunk.size();
+    }
+
+    uint64_t leaves = (index != nullptr) ? index->getTileCount() : 0;
+
+    header.nameOffset        = alignSection(sizeof(LevelFileHeader));
+    header.typesOffset       = alignSection(header.nameOffset + header.nameLength);
+    header.tilesOffset       = alignSection(header.typesOffset + header.typeCount*sizeof(LevelFileType));
+    header.mergedOffset      = alignSection(header.tilesOffset + header.tileCount*sizeof(LevelFileTile));
+    header.indexBoxesOffset  = alignSection(header.mergedOffset + header.mergedCount*sizeof(LevelFileTile));
+    header.indexOrderOffset  = alignSection(header.indexBoxesOffset + header.indexBoxCount*sizeof(StaticTileIndex::Box));
+    header.indexLevelsOffset = alignSection(header.indexOrderOffset + leaves*sizeof(uint32_t));
+
+    header.chunksOffset      = alignSection(header.indexLevelsOffset + header.indexLevelCount*sizeof(int32_t));
+    header.chunkTilesOffset  = alignSection(header.chunksOffset + header.chunkCount*sizeof(LevelFileChunk));
+
+    uint64_t fileSize = header.chunkTilesOffset + header.chunkTileCount*sizeof(LevelFileTile);
+
+    /* -- Contents -- */
+
+    vector<uint8_t> out(fileSize, 0);
+
+    memcpy(&out[0], &header, sizeof(LevelFileHeader));
+    memcpy(&out[header.nameOffset], name.data(), name.size());
+
+    for (uint32_t i = 0; i < header.typeCount; i++) {
+        LevelFileType type = {tileTypesTable[i].gridWidth, tileTypesTable[i].gridHeight};
+        memcpy(&out[header.typesOffset + i*sizeof(LevelFileType)], &type, sizeof(LevelFileType));
+    }
+
+    for (uint32_t i = 0; i < header.tileCount; i++) {
+        LevelFileTile record = toRecord(tiles[i]);
+        memcpy(&out[header.tilesOffset + i*sizeof(LevelFileTile)], &record, sizeof(LevelFileTile));
+    }
+
+    for (uint32_t i = 0; i < header.mergedCount; i++) {
+        LevelFileTile record = toRecord((*merged)[i]);
+        memcpy(&out[header.mergedOffset + i*sizeof(LevelFileTile)], &record, sizeof(LevelFileTile));
+    }
+
+    if (header.indexBoxCount > 0) {
+        Tile* first = level.getCollisionTiles().data();
+
+        memcpy(
+            &out[header.indexBoxesOffset],
+            index->getBoxes(),
+            header.indexBoxCount*sizeof(StaticTileIndex::Box)
+        );
+
+        for (uint64_t i = 0; i < leaves; i++) {
+            uint32_t tile = index->getLeafTile(i) - first;
+            memcpy(&out[header.indexOrderOffset + i*sizeof(uint32_t)], &tile, sizeof(uint32_t));
+        }
+
+        for (uint32_t i = 0; i < header.indexLevelCount; i++) {
+            int32_t levelEnd = index->getLevelEnds()[i];
+            memcpy(&out[header.indexLevelsOffset + i*sizeof(int32_t)], &levelEnd, sizeof(int32_t));
+        }
+    }
+
+    uint32_t chunkIndex = 0;
+    uint32_t firstTile  = 0;
+
+    for (auto& [position, chunk] : chunkTiles) {
+        LevelFileChunk record = {
+            position.second,
+            position.first,
+            firstTile,
+            static_cast<uint32_t>(chunk.size())
+        };
+
+        memcpy(&out[header.chunksOffset + chunkIndex*sizeof(LevelFileChunk)], &record, sizeof(LevelFileChunk));
+        memcpy(&out[header.chunkTilesOffset + firstTile*sizeof(LevelFileTile)], chunk.data(), chunk.size()*sizeof(LevelFileTile));
+
+        chunkIndex++;
+        firstTile += chunk.size();
+    }
+
+    delete(index);
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+
+    file.write(reinterpret_cast<const char*>(out.data()), out.size());
+
+    return file.good();
+}
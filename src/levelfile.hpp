@@ -0,0 +1,172 @@
+// The binary level format, which levels are loaded from at runtime
+
+#ifndef LEVELFILE_HPP
+#define LEVELFILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "tileindex.hpp"
+
+using std::string;
+using std::vector;
+
+class Level;
+
+// Where World::loadLevel looks for level files by default, and their extension
+// The build sets LEVELS_DIRECTORY_PATH to the directory it generates level
+// files in, so that they're found from any working directory
+// Not strings, so that they can be used while other globals are constructed
+#ifdef LEVELS_DIRECTORY_PATH
+const char LEVELS_DIRECTORY[]     = LEVELS_DIRECTORY_PATH;
+#else
+const char LEVELS_DIRECTORY[]     = "levels";
+#endif
+const char LEVEL_FILE_EXTENSION[] = ".lvl";
+
+// Identifies level files, along with LEVEL_FILE_VERSION
+const char     LEVEL_FILE_MAGIC[4] = {'P', 'G', 'L', 'V'};
+const uint32_t LEVEL_FILE_VERSION  = 2;
+
+// Size of the chunks which levels are split into for streaming, in grid cells
+const int LEVEL_CHUNK_SIZE = 16;
+
+/*
+ * Comes first in every level file, followed by each section at its offset
+ *
+ * - name:   the level's display name, nameLength characters
+ * - types:  LevelFileType per tile type, indexed by ID, including ID 0
+ * - tiles:  LevelFileTile per tile of the level
+ * - merged: LevelFileTile per merged collision tile, see
+ *           Level::mergeCollisionTiles
+ * - index:  a prebuilt StaticTileIndex over the collision tiles (the merged
+ *           ones, if there are any), as its boxes, the index of each leaf's
+ *           tile, and the end of each level of boxes
+ * - chunks: LevelFileChunk per chunk of chunkSize*chunkSize cells that
+ *           contains any tiles, sorted by chunkY then chunkX
+ * - chunk tiles: LevelFileTile per tile of each chunk, grouped by chunk,
+ *           with tiles that span several chunks cut at the chunks' edges
+ *
+ * The merged tiles, the index and the chunks are optional, and have a count
+ * of 0 when left out. Every section is aligned to 8 bytes, and all values are
+ * stored in the byte order of the machine that wrote the file.
+ */
+struct LevelFileHeader {
+    char     magic[4];
+    uint32_t version;
+    uint32_t nameLength;
+    uint32_t typeCount;
+    uint32_t tileCount;
+    uint32_t mergedCount;
+    uint32_t indexBoxCount;
+    uint32_t indexLevelCount;
+    uint32_t chunkSize;         // In grid cells
+    uint32_t chunkCount;
+    uint32_t chunkTileCount;
+    uint64_t nameOffset;
+    uint64_t typesOffset;
+    uint64_t tilesOffset;
+    uint64_t mergedOffset;
+    uint64_t indexBoxesOffset;
+    uint64_t indexOrderOffset;  // uint32_t per leaf box
+    uint64_t indexLevelsOffset; // int32_t per level
+    uint64_t chunksOffset;
+    uint64_t chunkTilesOffset;
+};
+
+// Size of a tile type, in grid cells
+struct LevelFileType {
+    int32_t gridWidth;
+    int32_t gridHeight;
+};
+
+// A tile, as passed to the Tile constructor
+struct LevelFileTile {
+    int32_t typeId;
+    int32_t gridX;
+    int32_t gridY;
+    int32_t gridWidth;
+    int32_t gridHeight;
+};
+
+// A chunk of a level, whose tiles are in the chunk tiles section
+struct LevelFileChunk {
+    int32_t  chunkX;    // In chunks, i.e. the chunk's first cell divided by
+    int32_t  chunkY;    // chunkSize
+    uint32_t firstTile;
+    uint32_t tileCount;
+};
+
+/*
+ * A level file, mapped into memory as is
+ *
+ * Opening a file only checks that its sections are within the file and hold
+ * valid values; nothing is copied out of it. Its tiles can then be read in
+ * place, and its prebuilt index used by a StaticTileIndex directly, as long
+ * as the LevelFile is kept open.
+ */
+class LevelFile {
+    private:
+        const uint8_t*         data = nullptr;
+        size_t                 size = 0;
+        const LevelFileHeader* header = nullptr;
+        vector<uint8_t>        buffer; // Holds the file where mmap isn't available
+
+        // Check that the file's header and sections are valid
+        bool validate() const;
+
+        // Unmap the file, if it's mapped
+        void unmap();
+    public:
+        // Opens and maps a file
+        // isOpen() returns false if it couldn't be, or isn't a valid level
+        LevelFile(string path);
+        LevelFile(const LevelFile&) = delete;
+        LevelFile& operator=(const LevelFile&) = delete;
+
+        ~LevelFile();
+
+        bool isOpen() const;
+
+        string getDisplayName() const;
+
+        int                  getTileCount() const;
+        const LevelFileTile* getTiles() const;
+
+        // 0 if the file doesn't contain merged collision tiles
+        int                  getMergedCount() const;
+        const LevelFileTile* getMergedTiles() const;
+
+        // Whether or not the file contains a prebuilt index
+        bool hasIndex() const;
+
+        // 0 if the file isn't split into chunks
+        int                   getChunkCount() const;
+        int                   getChunkSize() const;
+        const LevelFileChunk* getChunks() const;
+        const LevelFileTile*  getChunkTiles() const;
+
+        // Index of the chunk at the given chunk coordinates, or -1 if that
+        // chunk contains no tiles
+        int findChunk(int chunkX, int chunkY) const;
+
+        // Create a StaticTileIndex from the file's prebuilt index, which uses
+        // the file's boxes in place
+        // tiles must be the level's collision tiles, in the file's order
+        StaticTileIndex* createIndex(vector<Tile>& tiles) const;
+};
+
+// Whether or not a level can be given this name, which its file is named after
+// Only letters, digits, '_' and '-' are allowed, so that names can't point
+// outside of the levels directory
+extern bool isValidLevelName(const string& levelName);
+
+// Write a level to a file, along with its merged collision tiles (if they've
+// been merged), an index over its collision tiles, and its tiles split into
+// chunks of LEVEL_CHUNK_SIZE
+// Returns false if the file couldn't be written
+extern bool writeLevelFile(string path, Level& level, bool withIndex = true);
+
+#endif
@@ -1,15 +1,37 @@
 #include "levels.hpp"
 
+#include <algorithm>
+#include <climits>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
+#include "levelfile.hpp"
 #include "tiles.hpp"
 
+using std::max, std::min;
 using std::string;
-using std::unordered_map;
 using std::vector;
 
+// Create a tile for each of a level file's tile records
+static vector<Tile> loadTiles(const LevelFileTile* records, int count) {
+    vector<Tile> tiles;
+    tiles.reserve(count);
+
+    for (int i = 0; i < count; i++) {
+        const LevelFileTile& record = records[i];
+
+        tiles.emplace_back(
+            record.typeId,
+            record.gridX,
+            record.gridY,
+            record.gridWidth,
+            record.gridHeight
+        );
+    }
+
+    return tiles;
+}
+
 /* -- Level -- */
 
 // Constructors
@@ -18,140 +40,111 @@ Level::Level(string displayName, vector<Tile> tiles)
       tiles(tiles) {
 }
 
+Level::Level(const LevelFile& file, bool merge)
+    : displayName(file.getDisplayName()),
+      tiles(loadTiles(file.getTiles(), file.getTileCount())) {
+    if (!merge) return;
+
+    if (file.getMergedCount() > 0) {
+        this->mergedTiles = loadTiles(file.getMergedTiles(), file.getMergedCount());
+    } else {
+        this->mergeCollisionTiles();
+    }
+}
+
 // Getters
 string        Level::getDisplayName() const { return this->displayName; }
 vector<Tile>& Level::getTiles()             { return this->tiles; }
+bool          Level::hasMergedTiles() const { return !this->mergedTiles.empty(); }
+vector<Tile>& Level::getCollisionTiles() {
+    return (this->mergedTiles.empty()) ? this->tiles : this->mergedTiles;
+}
+
+// Other methods
+void Level::mergeCollisionTiles() {
+    this->mergedTiles.clear();
+
+    if (this->tiles.empty()) return;
+
+    // Find the area covered by all tiles, in grid coordinates
+    int minX = INT_MAX;
+    int minY = INT_MAX;
+    int maxX = INT_MIN;
+    int maxY = INT_MIN;
+
+    for (Tile& tile : this->tiles) {
+        TileAABB& bounds = tile.getBounds();
+
+        minX = min(minX, bounds.gridX);
+        minY = min(minY, bounds.gridY);
+        maxX = max(maxX, bounds.gridX + bounds.gridWidth);
+        maxY = max(maxY, bounds.gridY + bounds.gridHeight);
+    }
+
+    int width  = maxX - minX;
+    int height = maxY - minY;
 
-const unordered_map<string, Level> levelsTable = {
-    {"test", Level(
-        "Test",
-        {
-            Tile(
-                1,
-                6,
-                13
-            ),
-            Tile(
-                1,
-                7,
-                13
-            ),
-            Tile(
-                1,
-                8,
-                13
-            ),
-            Tile(
-                1,
-                9,
-                13
-            ),
-            Tile(
-                1,
-                10,
-                13
-            ),
-            Tile(
-                1,
-                10,
-                12
-            ),
-            Tile(
-                1,
-                10,
-                11
-            ),
-            Tile(
-                1,
-                10,
-                10
-            ),
-            Tile(
-                1,
-                11,
-                10
-            ),
-            Tile(
-                1,
-                12,
-                10
-            ),
-            Tile(
-                1,
-                13,
-                10
-            ),
-            Tile(
-                1,
-                14,
-                10
-            ),
-            Tile(
-                1,
-                15,
-                10
-            ),
-            Tile(
-                1,
-                16,
-                10
-            ),
-            Tile(
-                1,
-                17,
-                10
-            ),
-            Tile(
-                1,
-                18,
-                10
-            ),
-            Tile(
-                1,
-                19,
-                10
-            ),
-            Tile(
-                1,
-                20,
-                10
-            ),
-            Tile(
-                1,
-                20,
-                11
-            ),
-            Tile(
-                1,
-                20,
-                12
-            ),
-            Tile(
-                1,
-                20,
-                13
-            ),
-            Tile(
-                1,
-                21,
-                13
-            ),
-            Tile(
-                1,
-                22,
-                13
-            ),
-            Tile(
-                1,
-                23,
-                13
-            ),
-            Tile(
-                1,
-                24,
-                13
-            )
+    // The type ID of the tile occupying each cell, or 0 if there's none
+    // Cells are set back to 0 once they've been merged
+    vector<int> cells(width*height, 0);
+
+    for (Tile& tile : this->tiles) {
+        TileAABB& bounds = tile.getBounds();
+
+        for (int y = bounds.gridY - minY; y < bounds.gridY - minY + bounds.gridHeight; y++) {
+            for (int x = bounds.gridX - minX; x < bounds.gridX - minX + bounds.gridWidth; x++) {
+                cells[y*width + x] = bounds.typeId;
+            }
         }
-    )}
-};
+    }
+
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            int typeId = cells[y*width + x];
+
+            if (typeId == 0) continue;
+
+            // Extend the run to the right for as long as the type matches
+            int runWidth = 1;
+
+            while (x + runWidth < width
+            &&     cells[y*width + x + runWidth] == typeId) {
+                runWidth++;
+            }
+
+            // Extend the run down for as long as the whole row below matches
+            int runHeight = 1;
 
+            while (y + runHeight < height) {
+                int  row     = (y + runHeight)*width;
+                bool rowFits = true;
+
+                for (int i = x; i < x + runWidth; i++) {
+                    if (cells[row + i] != typeId) {
+                        rowFits = false;
+                        break;
+                    }
+                }
+
+                if (!rowFits) break;
+
+                runHeight++;
+            }
+
+            // Mark the merged cells so they aren't merged again
+            for (int i = y; i < y + runHeight; i++) {
+                for (int j = x; j < x + runWidth; j++) {
+                    cells[i*width + j] = 0;
+                }
+            }
+
+            this->mergedTiles.push_back(Tile(
+                typeId,
+                minX + x,
+                minY + y,
+                runWidth,
+                runHeight
+            ));
+        }
+    }
+}
@@ -4,28 +4,52 @@
 #define LEVELS_HPP
 
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 #include "tiles.hpp"
 
 using std::string;
-using std::unordered_map;
 using std::vector;
 
+class LevelFile;
+
 // A group of tiles which represents a playable level
 class Level {
     private:
         string       displayName;
         vector<Tile> tiles;
+        vector<Tile> mergedTiles; // Filled by mergeCollisionTiles()
     public:
         Level(string displayName, vector<Tile> tiles);
 
+        // Creates a level from the tiles of a level file
+        // If merge is set, the file's merged collision tiles are used, or
+        // merged again if the file doesn't contain any
+        Level(const LevelFile& file, bool merge);
+
         string        getDisplayName() const;
         vector<Tile>& getTiles();
-};
 
-// All Level definitions go here
-extern const unordered_map<string, Level> levelsTable;
+        // Whether or not mergeCollisionTiles() has been called, or merged
+        // tiles were loaded from a level file
+        bool hasMergedTiles() const;
+
+        // The tiles which should be used for collision checks
+        // Same as getTiles(), unless mergeCollisionTiles() has been called
+        vector<Tile>& getCollisionTiles();
+
+        /*
+         * Merge adjacent tiles of the same type into larger tiles, so that
+         * there are fewer of them to check collisions against
+         *
+         * Works greedily: each row of the level is scanned for runs of tiles
+         * of the same type, and each run is extended down for as many rows as
+         * it stays fully covered
+         *
+         * The result is only used by getCollisionTiles(), the level's tiles
+         * themselves are left untouched
+         */
+        void mergeCollisionTiles();
+};
 
 #endif
@@ -1,19 +1,52 @@
 //TODO: readme file
 
+// Usage: 2d-physics-game [--record <file>] [--replay <file>] [--levels <dir>]
+// Recordings can also be replayed by 2d-physics-headless
+// Levels are read from the directory the build generated them in, unless
+// --levels is given
+
 #include <SDL2/SDL.h>
+#include <cmath>
+#include <iostream>
+#include <string>
 
 #include "events.hpp"
 #include "game.hpp"
 #include "graphics.hpp"
+#include "pacer.hpp"
+#include "profiler.hpp"
 #include "util.hpp"
+#include "window.hpp"
+#include "world.hpp"
+
+// Printed with --help, or when the arguments aren't valid
+const char USAGE[] = "Usage: 2d-physics-game [--record <file>] [--replay <file>] [--levels <dir>]\n";
 
 double dt = 0;
 
-// The number acquired from SDL_GetPerformanceCounter() the previous frame
-// For calculating delta time
-Uint64 ticksLast = 0;
+FramePacer framePacer;
+
+// Time that's passed but hasn't been simulated yet, in 60ths of a second
+double stepAccumulator = 0;
 
 int main(int argc, char** argv) {
+    if (argc > 1 && (std::string(argv[1]) == "--help" || std::string(argv[1]) == "-h")) {
+        std::cout << USAGE;
+        return 0;
+    }
+
+    // Every option takes a value, so anything else is rejected before the
+    // window is opened
+    for (int i = 1; i < argc; i += 2) {
+        std::string option = argv[i];
+
+        if (i + 1 >= argc
+        ||  (option != "--record" && option != "--replay" && option != "--levels")) {
+            std::cerr << USAGE;
+            return 1;
+        }
+    }
+
     if (!init()) return 1;
 
     debugMode = 0
@@ -24,27 +57,115 @@ int main(int argc, char** argv) {
                 | DEBUG_SHOW_HITBOXES
                 | DEBUG_SHOW_QUADS
                 // | DEBUG_SUBTICK_RENDERS
+                // | DEBUG_PROFILE
+                // | DEBUG_METRICS
                 ;
 
+    // Structure used for tile collision checks, can be switched to compare
+    // them on the same level
+    // TILE_QUERY_STREAM only keeps the chunks of the level around the player
+    world.tileQueryMode = TILE_QUERY_GRID; // TILE_QUERY_TREE, TILE_QUERY_INDEX, TILE_QUERY_STREAM
+
+    // Merge level tiles into larger collision boxes when loading levels
+    world.mergeLevelTiles = true;
+
+    // Frames per second, and how long before each frame to stop sleeping and
+    // spin instead, in seconds
+    framePacer.setTargetRate(60);
+    framePacer.setSpinThreshold(0.001);
+
+    if (debugMode & DEBUG_SUBTICK_RENDERS) {
+        world.onSubtick = doRender;
+    }
+
+    if (debugMode & DEBUG_PROFILE) {
+        profilerEnabled = true;
+    }
+
+    if (debugMode & DEBUG_METRICS) {
+        metricsEnabled = true;
+    }
+
+    // Record the player's input to a file, or replay it from one, and pick
+    // where levels are read from
+    std::string recordPath;
+
+    for (int i = 1; i < argc; i += 2) {
+        std::string option = argv[i];
+
+        if (option == "--record") {
+            recordPath = argv[i + 1];
+        } else if (option == "--replay" && !inputReplay.open(argv[i + 1])) {
+            std::cout << "ERROR: Couldn't read input replay " << argv[i + 1] << '\n';
+        } else if (option == "--levels") {
+            world.levelsDirectory = argv[i + 1];
+        }
+    }
+
+    // Replays only play out the same on the level and with the settings they
+    // were recorded with
+    if (inputReplay.isOpen()) {
+        gameLevel             = inputReplay.getLevelName();
+        world.tileQueryMode   = inputReplay.getTileQueryMode();
+        world.mergeLevelTiles = inputReplay.getMergeLevelTiles();
+    }
+
+    // Opened once the level and settings are final, as they're recorded along
+    // with the input
+    if (!recordPath.empty()
+    &&  !inputRecorder.open(recordPath, gameLevel, world.tileQueryMode, world.mergeLevelTiles)) {
+        std::cout << "ERROR: Couldn't write " << recordPath << '\n';
+    }
+
     if (debugMode & DEBUG_CONFIGS) {
         // Prevents SDL from stealing the mouse cursor when a breakpoint is hit
         SDL_SetHint(SDL_HINT_MOUSE_AUTO_CAPTURE, "0");
     }
 
     while (true) {
-        // Update delta time
-        dt = SDL_GetPerformanceCounter() - ticksLast;
-        dt *= 60.0/SDL_GetPerformanceFrequency();
+        // Sleep until the next frame is due, then update delta time
+        dt = framePacer.waitForNextFrame()*60;
+
+        ScopedTimer frameTimer("frame");
+
+        {
+            ScopedTimer eventsTimer("events");
 
-        if (dt < 1) continue;
+            if (!doEvents()) break;
+        }
 
-        ticksLast = SDL_GetPerformanceCounter();
+        // Simulate the time that's passed in fixed steps, capped so that a
+        // slow frame doesn't lead to even slower ones
+        stepAccumulator += dt;
 
-        if (!doEvents()) break;
-        doGame();
+        for (int i = 0; i < MAX_STEPS_PER_FRAME && stepAccumulator >= STEP_LENGTH; i++) {
+            doGame();
+            stepAccumulator -= STEP_LENGTH;
+        }
+
+        if (gameState == GS_FINISHED || gameState == GS_FAILED) break;
+
+        // Drop whatever couldn't be caught up on
+        stepAccumulator = fmod(stepAccumulator, STEP_LENGTH);
+
+        // Render objects partway between their last two states, based on how
+        // far into the next step the frame is
+        world.physics.renderAlpha = stepAccumulator/STEP_LENGTH;
+
+        ScopedTimer renderTimer("render");
         doRender();
     }
 
+    if (debugMode & DEBUG_PROFILE) {
+        printProfileSummary(std::cout);
+
+        if (!exportChromeTrace(PROFILE_TRACE_PATH)) {
+            std::cout << "ERROR: Couldn't write " << PROFILE_TRACE_PATH << '\n';
+        }
+    }
+
+    inputRecorder.close();
+
     kill();
-    return 0;
+    return (gameState == GS_FAILED) ? 1 : 0;
 }
@@ -0,0 +1,96 @@
+#include "metrics.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+#include <vector>
+
+using std::setw;
+using std::vector;
+
+// Function-local, so that it exists before any counter registers itself
+static vector<Counter*>& counterRegistry() {
+    static vector<Counter*> counters;
+
+    return counters;
+}
+
+bool metricsEnabled = false;
+
+Counter quadTreeNodes("quadtree_nodes");
+Counter quadTreeDepth("quadtree_depth");
+Counter quadTreeInnerItems("quadtree_inner_items");
+Counter quadTreeQueries("quadtree_queries");
+Counter quadTreeCandidates("quadtree_candidates");
+Counter quadTreeRelocations("quadtree_relocations");
+Counter tileQueries("tile_queries");
+Counter tileCandidates("tile_candidates");
+Counter intersectTests("intersect_tests");
+Counter intersectHits("intersect_hits");
+Counter contactRestarts("contact_restarts");
+Counter treeUpdates("tree_updates");
+Counter streamChunks("stream_chunks");
+Counter streamStalls("stream_stalls");
+
+/* -- Counter -- */
+
+// Constructors
+Counter::Counter(const char* name)
+    : name(name) {
+    counterRegistry().push_back(this);
+}
+
+// Getters
+const char* Counter::getName() const { return this->name; }
+int64_t     Counter::getValue() const { return this->value.load(std::memory_order_relaxed); }
+
+// Other methods
+void Counter::add(int64_t amount) {
+    this->value.fetch_add(amount, std::memory_order_relaxed);
+}
+void Counter::set(int64_t value) {
+    this->value.store(value, std::memory_order_relaxed);
+}
+void Counter::reset() {
+    this->set(0);
+}
+
+/* -- Utility methods -- */
+
+const vector<Counter*>& getCounters() {
+    return counterRegistry();
+}
+
+void resetCounters() {
+    for (Counter* counter : counterRegistry()) {
+        counter->reset();
+    }
+}
+
+void printCounters(ostream& out) {
+    for (Counter* counter : counterRegistry()) {
+        out << setw(22) << string(counter->getName()) + "="
+            << setw(16) << counter->getValue() << '\n';
+    }
+}
+
+void writeCountersHeader(ostream& out) {
+    out << "tick";
+
+    for (Counter* counter : counterRegistry()) {
+        out << ',' << counter->getName();
+    }
+
+    out << '\n';
+}
+
+void writeCountersRow(ostream& out, int64_t tick) {
+    out << tick;
+
+    for (Counter* counter : counterRegistry()) {
+        out << ',' << counter->getValue();
+    }
+
+    out << '\n';
+}
@@ -0,0 +1,78 @@
+// Counters for the work done by the broadphase and narrowphase every tick
+
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+using std::ostream;
+using std::string;
+using std::vector;
+
+/*
+ * A named count, registered in the metrics registry on construction
+ *
+ * Counters are meant to be defined globally, and are only updated while
+ * metricsEnabled is set, so they cost a single branch when disabled.
+ */
+class Counter {
+    private:
+        const char*          name;
+        std::atomic<int64_t> value{0};
+    public:
+        Counter(const char* name);
+        Counter(const Counter&) = delete;
+        Counter& operator=(const Counter&) = delete;
+
+        const char* getName() const;
+        int64_t     getValue() const;
+
+        void add(int64_t amount = 1);
+        void set(int64_t value);
+        void reset();
+};
+
+// Whether or not counters should be updated
+extern bool metricsEnabled;
+
+// Broadphase
+extern Counter quadTreeNodes;       // Nodes in use by gameObjectsTree
+extern Counter quadTreeDepth;       // Deepest level of gameObjectsTree
+extern Counter quadTreeInnerItems;  // Items held by nodes with quadrants
+extern Counter quadTreeQueries;     // Queries made to any QuadTree
+extern Counter quadTreeCandidates;  // Items visited by those queries
+extern Counter quadTreeRelocations; // Items moved to a different node
+extern Counter tileQueries;         // Tile queries made by the collision phase
+extern Counter tileCandidates;      // Tiles returned by those queries
+
+// Narrowphase
+extern Counter intersectTests;      // Object-tile intersection tests
+extern Counter intersectHits;       // Tests that found an intersection
+extern Counter contactRestarts;     // Extra contact iterations after the first
+extern Counter treeUpdates;         // Objects updated in gameObjectsTree
+
+// Streaming
+extern Counter streamChunks;        // Chunks held by tilesStream
+extern Counter streamStalls;        // Chunks needed before they were loaded
+
+// All registered counters, in the order they were defined
+extern const vector<Counter*>& getCounters();
+
+// Reset every counter to 0
+extern void resetCounters();
+
+// Print every counter as name=value, one per line
+extern void printCounters(ostream& out);
+
+// Write a CSV header, starting with a tick column and followed by the name of
+// every counter
+extern void writeCountersHeader(ostream& out);
+
+// Write the values of every counter as a CSV row, starting with the tick
+extern void writeCountersRow(ostream& out, int64_t tick);
+
+#endif
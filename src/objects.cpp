@@ -8,12 +8,67 @@
 #include <string>
 #include <stdexcept>
 
+#include "physics.hpp"
+#include "tileindex.hpp"
+#include "tilestream.hpp"
 #include "tiles.hpp"
 #include "util.hpp"
 
-using std::abs, std::min;
+using std::abs, std::max, std::min;
 using std::string;
 
+// Find when a box moving by (moveX, moveY) would start overlapping a tile, as a
+// fraction of the movement from 0 to 1
+// Returns -1 if it wouldn't during the movement, or if they already overlap
+// hitX is set to whether the box would hit the tile's left or right side,
+// rather than its top or bottom
+static double sweepTile(
+    const AABB&     box,
+    double          moveX,
+    double          moveY,
+    const TileAABB& tile,
+    bool&           hitX
+) {
+    double entryX, exitX;
+    double entryY, exitY;
+
+    if (moveX > 0) {
+        entryX = (tile.getLeftX() - box.getRightX())/moveX;
+        exitX  = (tile.getRightX() - box.getLeftX())/moveX;
+    } else if (moveX < 0) {
+        entryX = (tile.getRightX() - box.getLeftX())/moveX;
+        exitX  = (tile.getLeftX() - box.getRightX())/moveX;
+    } else if (box.getRightX() > tile.getLeftX() && box.getLeftX() < tile.getRightX()) {
+        entryX = -INFINITY;
+        exitX  = INFINITY;
+    } else {
+        return -1;
+    }
+
+    if (moveY > 0) {
+        entryY = (tile.getTopY() - box.getBottomY())/moveY;
+        exitY  = (tile.getBottomY() - box.getTopY())/moveY;
+    } else if (moveY < 0) {
+        entryY = (tile.getBottomY() - box.getTopY())/moveY;
+        exitY  = (tile.getTopY() - box.getBottomY())/moveY;
+    } else if (box.getBottomY() > tile.getTopY() && box.getTopY() < tile.getBottomY()) {
+        entryY = -INFINITY;
+        exitY  = INFINITY;
+    } else {
+        return -1;
+    }
+
+    // The box overlaps the tile once it overlaps on both axes, and stops once
+    // it stops overlapping on either
+    double entry = max(entryX, entryY);
+    double exit  = min(exitX, exitY);
+
+    if (entry < 0 || entry > 1 || entry >= exit) return -1;
+
+    hitX = entryX > entryY;
+    return entry;
+}
+
 /* -- AABB -- */
 
 // Constructors
@@ -22,74 +77,141 @@ AABB::AABB(vec2<double> center, double halfWidth, double halfHeight)
       halfWidth(halfWidth),
       halfHeight(halfHeight) {}
 
+/* -- ContactManifold -- */
+
 // Getters
-double AABB::getTopY() const    { return this->center.y - this->halfHeight; }
-double AABB::getBottomY() const { return this->center.y + this->halfHeight; }
-double AABB::getLeftX() const   { return this->center.x - this->halfWidth; }
-double AABB::getRightX() const  { return this->center.x + this->halfWidth; }
+double ContactManifold::getTranslationX() const {
+    return this->pushRight - this->pushLeft;
+}
+double ContactManifold::getTranslationY() const {
+    return this->pushDown - this->pushUp;
+}
+
+// Other methods
+void ContactManifold::clear() {
+    this->count = 0;
+    this->pushLeft = 0;
+    this->pushRight = 0;
+    this->pushUp = 0;
+    this->pushDown = 0;
+}
+
+void ContactManifold::add(const AABB& box, const TileAABB& tile) {
+    // How far the box would have to move in each direction to leave the tile
+    double overlapLeft  = box.getRightX() - tile.getLeftX();
+    double overlapRight = tile.getRightX() - box.getLeftX();
+    double overlapUp    = box.getBottomY() - tile.getTopY();
+    double overlapDown  = tile.getBottomY() - box.getTopY();
+
+    if (overlapLeft <= 0 || overlapRight <= 0
+    ||  overlapUp   <= 0 || overlapDown  <= 0) {
+        return;
+    }
+
+    this->count++;
+
+    // Ties go to the Y axis, so objects landing on a tile's corner stay on it
+    if (min(overlapUp, overlapDown) <= min(overlapLeft, overlapRight)) {
+        if (overlapUp <= overlapDown) {
+            this->pushUp = max(this->pushUp, overlapUp);
+        } else {
+            this->pushDown = max(this->pushDown, overlapDown);
+        }
+    } else {
+        if (overlapLeft <= overlapRight) {
+            this->pushLeft = max(this->pushLeft, overlapLeft);
+        } else {
+            this->pushRight = max(this->pushRight, overlapRight);
+        }
+    }
+}
 
 /* -- GameObject -- */
 
 /* 
  * IMPORTANT: For most cases, even internally, you do not want to manipulate
- * this->bounds.center, since it refers to the bounding box's center,
- * without accounting for the object's pivot! Instead, use the proper getters
- * and setters
+ * the physics slot's centerX and centerY, since they refer to the bounding
+ * box's center, without accounting for the object's pivot! Instead, use the
+ * proper getters and setters
  */
 
-// Getters
-AABB&        GameObject::getBounds()              { return this->bounds; }
-double       GameObject::getPivotX() const        { return this->pivotX; }
-double       GameObject::getPivotY() const        { return this->pivotY; }
-double       GameObject::getSpeedX() const        { return this->speedX; }
-double       GameObject::getSpeedY() const        { return this->speedY; }
-double       GameObject::getMoveSpeed() const     { return this->moveSpeed; }
-string       GameObject::getState() const         { return this->state; }
-vec2<double> GameObject::getDirection() const     { return this->direction; }
-eDirTypes    GameObject::getDirectionType() const { return this->directionType; }
-double       GameObject::getWeight() const        { return this->weight; }
-vec2<double> GameObject::getAimDirection() const  { return this->aimDirection; }
-double       GameObject::getAimOriginX() const    { return this->aimOriginX; }
-double       GameObject::getAimOriginY() const    { return this->aimOriginY; }
-int          GameObject::getHealth() const        { return this->health; }
+// Constructors
+GameObject::GameObject(PhysicsWorld& physics)
+    : physics(&physics),
+      slot(physics.add(this)) {}
 
+// Getters
+PhysicsWorld& GameObject::getPhysics() const       { return *this->physics; }
+int           GameObject::getSlot() const          { return this->slot; }
+double        GameObject::getPivotX() const        { return this->pivotX; }
+double        GameObject::getPivotY() const        { return this->pivotY; }
+double        GameObject::getSpeedX() const        { return this->physics->speedX[this->slot]; }
+double        GameObject::getSpeedY() const        { return this->physics->speedY[this->slot]; }
+double        GameObject::getMoveSpeed() const     { return this->moveSpeed; }
+string        GameObject::getState() const         { return this->state; }
+vec2<double>  GameObject::getDirection() const     { return this->direction; }
+eDirTypes     GameObject::getDirectionType() const { return this->directionType; }
+double        GameObject::getWeight() const        { return this->physics->weight[this->slot]; }
+vec2<double>  GameObject::getAimDirection() const  { return this->aimDirection; }
+double        GameObject::getAimOriginX() const    { return this->aimOriginX; }
+double        GameObject::getAimOriginY() const    { return this->aimOriginY; }
+int           GameObject::getHealth() const        { return this->physics->health[this->slot]; }
+bool          GameObject::isDead() const           { return this->dead; }
+
+AABB GameObject::getBounds() const {
+    return AABB(
+        {this->physics->centerX[this->slot], this->physics->centerY[this->slot]},
+        this->physics->halfWidth[this->slot],
+        this->physics->halfHeight[this->slot]
+    );
+}
 double GameObject::getX() const {
-    return this->bounds.center.x + this->bounds.halfWidth*this->pivotX;
+    return this->physics->centerX[this->slot]
+         + this->physics->halfWidth[this->slot]*this->pivotX;
 }
 double GameObject::getY() const {
-    return this->bounds.center.y + this->bounds.halfHeight*this->pivotY;
+    return this->physics->centerY[this->slot]
+         + this->physics->halfHeight[this->slot]*this->pivotY;
 }
 double GameObject::getWidth() const {
-    return this->bounds.halfWidth*2;
+    return this->physics->halfWidth[this->slot]*2;
 }
 double GameObject::getHeight() const {
-    return this->bounds.halfHeight*2;
+    return this->physics->halfHeight[this->slot]*2;
 }
 double GameObject::getAimX() const {
-    return this->bounds.center.x + this->bounds.halfWidth*this->aimOriginX;
+    return this->physics->centerX[this->slot]
+         + this->physics->halfWidth[this->slot]*this->aimOriginX;
 }
 double GameObject::getAimY() const {
-    return this->bounds.center.y + this->bounds.halfHeight*this->aimOriginY;
+    return this->physics->centerY[this->slot]
+         + this->physics->halfHeight[this->slot]*this->aimOriginY;
 }
 double GameObject::getScreenX() const {
-    return this->getX();
+    double lastX = this->physics->lastCenterX[this->slot];
+    double x     = lastX + (this->physics->centerX[this->slot] - lastX)*this->physics->renderAlpha;
+
+    return x + this->physics->halfWidth[this->slot]*this->pivotX;
 }
 double GameObject::getScreenY() const {
-    return this->getY();
+    double lastY = this->physics->lastCenterY[this->slot];
+    double y     = lastY + (this->physics->centerY[this->slot] - lastY)*this->physics->renderAlpha;
+
+    return y + this->physics->halfHeight[this->slot]*this->pivotY;
 }
 
 // Setters
 void GameObject::setWidth(double width) {
-    this->bounds.halfWidth = width/2;
+    this->physics->halfWidth[this->slot] = width/2;
 }
 void GameObject::setHeight(double height) {
-    this->bounds.halfHeight = height/2;
+    this->physics->halfHeight[this->slot] = height/2;
 }
 void GameObject::setSpeedX(double speedX) {
-    this->speedX = speedX;
+    this->physics->speedX[this->slot] = speedX;
 }
 void GameObject::setSpeedY(double speedY) {
-    this->speedY = speedY;
+    this->physics->speedY[this->slot] = speedY;
 }
 void GameObject::setMoveSpeed(double moveSpeed) {
     this->moveSpeed = moveSpeed;
@@ -130,73 +252,198 @@ bool GameObject::setDirection(vec2<double> direction) {
     return true;
 }
 void GameObject::setWeight(double weight) {
-    this->weight = weight;
+    this->physics->weight[this->slot] = weight;
 }
 
 // Other methods
 bool GameObject::isVisible() const {
     return true;
 }
+void GameObject::markDead() {
+    this->dead = true;
+}
+void GameObject::saveState(ObjectState& state) const {
+    state.pivotX        = this->pivotX;
+    state.pivotY        = this->pivotY;
+    state.moveSpeed     = this->moveSpeed;
+    state.directionX    = this->direction.x;
+    state.directionY    = this->direction.y;
+    state.aimDirectionX = this->aimDirection.x;
+    state.aimDirectionY = this->aimDirection.y;
+    state.aimOriginX    = this->aimOriginX;
+    state.aimOriginY    = this->aimOriginY;
+    state.frictionAdd   = 0;
+    state.frictionMult  = 0;
+    state.owner         = -1;
+    state.lifespan      = -1;
+    state.directionType = static_cast<uint8_t>(this->directionType);
+    state.walkType      = static_cast<uint8_t>(this->walkType);
+    state.dead          = this->dead;
+}
+void GameObject::loadState(const ObjectState& state) {
+    this->pivotX        = state.pivotX;
+    this->pivotY        = state.pivotY;
+    this->moveSpeed     = state.moveSpeed;
+    this->direction     = {state.directionX, state.directionY};
+    this->aimDirection  = {state.aimDirectionX, state.aimDirectionY};
+    this->aimOriginX    = state.aimOriginX;
+    this->aimOriginY    = state.aimOriginY;
+    this->directionType = static_cast<eDirTypes>(state.directionType);
+    this->walkType      = static_cast<eWalkTypes>(state.walkType);
+    this->dead          = state.dead;
+}
 void GameObject::teleport(double x, double y) {
-    double destX = x - this->bounds.halfWidth*this->pivotX;
-    double destY = y - this->bounds.halfHeight*this->pivotY;
+    double destX = x - this->physics->halfWidth[this->slot]*this->pivotX;
+    double destY = y - this->physics->halfHeight[this->slot]*this->pivotY;
 
-    this->bounds.center.x = destX;
-    this->bounds.center.y = destY;
+    this->physics->centerX[this->slot] = destX;
+    this->physics->centerY[this->slot] = destY;
+    this->physics->lastCenterX[this->slot] = destX;
+    this->physics->lastCenterY[this->slot] = destY;
 }
 void GameObject::thrust(double addX, double addY) {
-    this->speedX += addX;
-    this->speedY += addY;
+    this->physics->speedX[this->slot] += addX;
+    this->physics->speedY[this->slot] += addY;
 }
 bool GameObject::tryMove(double x, double y) {
-    this->teleport(x, y);
+    double& centerX = this->physics->centerX[this->slot];
+    double& centerY = this->physics->centerY[this->slot];
+    double  moveX   = x - this->physics->halfWidth[this->slot]*this->pivotX - centerX;
+    double  moveY   = y - this->physics->halfHeight[this->slot]*this->pivotY - centerY;
+
+    const StaticTileIndex*    tiles      = this->physics->tiles;
+    const StreamingTileIndex* tileStream = this->physics->tileStream;
+
+    if (tiles == nullptr && tileStream == nullptr) {
+        centerX += moveX;
+        centerY += moveY;
+        return true;
+    }
 
-    return true;
+    for (int i = 0; i < MOVE_MAX_SLIDES; i++) {
+        AABB bounds = this->getBounds();
+
+        // Only tiles within the area covered by the whole movement can be hit
+        AABB sweptBounds = AABB(
+            {centerX + moveX/2, centerY + moveY/2},
+            bounds.halfWidth + abs(moveX)/2,
+            bounds.halfHeight + abs(moveY)/2
+        );
+
+        // Find the first tile in the way
+        TileAABB* hitTile = nullptr;
+        double    hitTime = 1;
+        bool      hitX    = false;
+
+        auto sweep = [&](Tile* tile) {
+            bool   tileHitX;
+            double time = sweepTile(bounds, moveX, moveY, tile->getBounds(), tileHitX);
+
+            if (time >= 0 && (hitTile == nullptr || time < hitTime)) {
+                hitTile = &tile->getBounds();
+                hitTime = time;
+                hitX = tileHitX;
+            }
+
+            return true;
+        };
+
+        if (tileStream != nullptr) {
+            tileStream->forEachPossibleCollision(sweptBounds, sweep);
+        } else {
+            tiles->forEachPossibleCollision(sweptBounds, sweep);
+        }
+
+        if (hitTile == nullptr) {
+            centerX += moveX;
+            centerY += moveY;
+            return i == 0;
+        }
+
+        // Stop right against the tile, then slide along it with whatever is
+        // left of the movement
+        if (hitX) {
+            centerX = (moveX > 0) ? hitTile->getLeftX() - bounds.halfWidth
+                                  : hitTile->getRightX() + bounds.halfWidth;
+            centerY += moveY*hitTime;
+
+            moveX = 0;
+            moveY *= 1 - hitTime;
+            this->physics->speedX[this->slot] = 0;
+        } else {
+            centerX += moveX*hitTime;
+            centerY = (moveY > 0) ? hitTile->getTopY() - bounds.halfHeight
+                                  : hitTile->getBottomY() + bounds.halfHeight;
+
+            if (moveY > 0) {
+                this->physics->grounded[this->slot] = true;
+            }
+
+            moveX *= 1 - hitTime;
+            moveY = 0;
+            this->physics->speedY[this->slot] = 0;
+        }
+    }
+
+    return false;
 }
 void GameObject::walk() {
-    this->speedX = this->direction.x * this->moveSpeed;
+    this->physics->speedX[this->slot] = this->direction.x * this->moveSpeed;
     if (this->walkType == eWalkTypes::aerial) {
-        this->speedY = this->direction.y * this->moveSpeed;
+        this->physics->speedY[this->slot] = this->direction.y * this->moveSpeed;
     }
 }
 void GameObject::walk(vec2<double> direction) {
     direction = direction.normalized();
 
-    this->speedX = direction.x * this->moveSpeed;
+    this->physics->speedX[this->slot] = direction.x * this->moveSpeed;
     if (this->walkType == eWalkTypes::aerial) {
-        this->speedY = direction.y * this->moveSpeed;
+        this->physics->speedY[this->slot] = direction.y * this->moveSpeed;
     }
 }
 
 void GameObject::aimAt(vec2<double> target) {
-    double aimX = this->bounds.center.x + this->bounds.halfWidth*this->aimOriginX;
-    double aimY = this->bounds.center.y + this->bounds.halfHeight*this->aimOriginY;
+    double aimX = this->getAimX();
+    double aimY = this->getAimY();
 
     this->aimDirection = {target.x - aimX, target.y - aimY};
     this->aimDirection = this->aimDirection.normalized();
 }
 
-void GameObject::onCollideTile(Tile* tile, vec2<int> intersection) {
-    //TEMP: teleport the object to the tile's top, regardless of collision angle
-    double destY = tile->getBounds().getTopY();
+void GameObject::onCollideTiles(const ContactManifold& contacts) {
+    double  moveX  = contacts.getTranslationX();
+    double  moveY  = contacts.getTranslationY();
+    double& speedX = this->physics->speedX[this->slot];
+    double& speedY = this->physics->speedY[this->slot];
 
-    // Adjust for the object's Y pivot
-    destY += this->bounds.halfHeight*(this->pivotY - 1);
+    this->physics->centerX[this->slot] += moveX;
+    this->physics->centerY[this->slot] += moveY;
 
-    this->teleport(this->getX(), destY);
-    this->speedY = 0;
+    // Stop moving into whatever the object was pushed out of
+    if ((moveX < 0 && speedX > 0) || (moveX > 0 && speedX < 0)) {
+        speedX = 0;
+    }
+    if ((moveY < 0 && speedY > 0) || (moveY > 0 && speedY < 0)) {
+        speedY = 0;
+    }
 
-    //TEMP: set grounded to true regardless of collision angle
-    this->grounded = true;
+    // Being pushed up means the object is standing on a tile
+    if (contacts.pushUp > 0) {
+        this->physics->grounded[this->slot] = true;
+    }
 }
 
-GameObject::~GameObject() {};
+GameObject::~GameObject() {
+    this->physics->remove(this->slot);
+};
 
 /* -- Player -- */
 
 // Constructors
-Player::Player(double x, double y) {
-    this->bounds = AABB({0, 0}, PLR_WIDTH/2, PLR_HEIGHT/2);
+Player::Player(PhysicsWorld& physics, double x, double y)
+    : GameObject(physics) {
+    this->setWidth(PLR_WIDTH);
+    this->setHeight(PLR_HEIGHT);
     this->moveSpeed = PLR_MOVESPEED;
     this->state = "stand";
     this->direction = DIR_RIGHT;
@@ -212,18 +459,23 @@ eObjTypes Player::getObjectType() {
 /* -- Projectile -- */
 
 // Constructors
-Projectile::Projectile() {
+Projectile::Projectile(
+    PhysicsWorld&             physics,
+    const ObjectPool<Player>& ownerPool,
+    Player*                   owner,
+    int                       lifespan,
+    double                    width,
+    double                    height
+) : GameObject(physics),
+    ownerPool(&ownerPool) {
     this->directionType = eDirTypes::omni;
-    this->weight = 0;
-}
-Projectile::Projectile(GameObject* owner, int lifespan, double width, double height)
-    : Projectile() {
-    this->owner = owner;
+    this->setWeight(0);
     this->lifespan = lifespan;
-    this->bounds.halfWidth = width/2;
-    this->bounds.halfHeight = height/2;
+    this->setWidth(width);
+    this->setHeight(height);
     
     if (owner != nullptr) {
+        this->owner = ownerPool.getHandle(owner);
         this->teleport(owner->getX(), owner->getY());
     }
 }
@@ -232,30 +484,61 @@ Projectile::Projectile(GameObject* owner, int lifespan, double width, double hei
 eObjTypes Projectile::getObjectType() {
     return eObjTypes::projectile;
 }
+Player* Projectile::getOwner() const {
+    return this->ownerPool->get(this->owner);
+}
 
 // Other methods
+void Projectile::saveState(ObjectState& state) const {
+    GameObject::saveState(state);
+
+    Player* owner = this->getOwner();
+
+    state.frictionAdd  = this->frictionAdd;
+    state.frictionMult = this->frictionMult;
+    state.owner        = (owner != nullptr) ? owner->getSlot() : -1;
+    state.lifespan     = this->lifespan;
+}
+void Projectile::loadState(const ObjectState& state) {
+    GameObject::loadState(state);
+
+    this->frictionAdd  = state.frictionAdd;
+    this->frictionMult = state.frictionMult;
+    this->lifespan     = state.lifespan;
+
+    // Owners can only be players, anything else is treated as no owner
+    GameObject* owner = (state.owner >= 0) ? this->physics->owners[state.owner] : nullptr;
+
+    if (owner != nullptr && owner->getObjectType() == eObjTypes::player) {
+        this->owner = this->ownerPool->getHandle(static_cast<Player*>(owner));
+    } else {
+        this->owner = PoolHandle();
+    }
+}
 void Projectile::tick() {
+    double& speedX = this->physics->speedX[this->slot];
+
     // Tick down the projectile's lifespan, if it's not negative
     if (this->lifespan == 0) {
-        this->health = 0;
+        this->physics->health[this->slot] = 0;
     } else if (this->lifespan > 0) {
         this->lifespan--;
     }
 
-    if (this->grounded) {
-        if (this->speedX != 0) {
+    if (this->physics->grounded[this->slot]) {
+        if (speedX != 0) {
             /* -- Friction -- */
 
             // How much speed should be lost due to friction
-            double spdReduction = abs(this->speedX)*this->frictionMult + this->frictionAdd;
+            double spdReduction = abs(speedX)*this->frictionMult + this->frictionAdd;
     
             // Directional factor to apply the speed loss to
-            int dir = (this->speedX > 0) ? 1 : -1;
+            int dir = (speedX > 0) ? 1 : -1;
     
             // Apply and cap the speed loss so the object isn't thrust backwards
-            this->speedX -= min(spdReduction, abs(this->speedX))*dir;
+            speedX -= min(spdReduction, abs(speedX))*dir;
         }
 
-        this->grounded = false;
+        this->physics->grounded[this->slot] = false;
     }
 }
\ No newline at end of file
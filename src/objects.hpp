@@ -6,9 +6,13 @@
 #ifndef OBJECTS_HPP
 #define OBJECTS_HPP
 
+#include <cstdint>
 #include <string>
 
+#include "physics.hpp"
+#include "pool.hpp"
 #include "tiles.hpp"
+#include "treeitem.hpp"
 #include "util.hpp"
 
 using std::string;
@@ -18,6 +22,10 @@ const int    PLR_WIDTH = 40;
 const int    PLR_HEIGHT = 80;
 const double PLR_MOVESPEED = 2.5;
 
+// Max. times GameObject::tryMove can stop at a tile and slide along it
+// Two is enough, since each slide stops the movement on one axis
+const int MOVE_MAX_SLIDES = 2;
+
 // Direction values for GameObjects that move orthogonally
 const vec2<double> DIR_NONE = {0, 0};
 const vec2<double> DIR_LEFT = {-1, 0};
@@ -50,17 +58,65 @@ enum class eObjTypes {
 class GameObject;
 
 // Axis-aligned bounding box
-struct AABB : public AABBCommon {
+// The getters are defined here so that intersectBoxes can inline them
+struct AABB final : public AABBCommon {
     vec2<double> center;
     double       halfWidth;
     double       halfHeight;
 
     AABB(vec2<double> center, double halfWidth, double halfHeight);
 
-    double getTopY() const override;
-    double getBottomY() const override;
-    double getLeftX() const override;
-    double getRightX() const override;
+    double getTopY() const override    { return this->center.y - this->halfHeight; }
+    double getBottomY() const override { return this->center.y + this->halfHeight; }
+    double getLeftX() const override   { return this->center.x - this->halfWidth; }
+    double getRightX() const override  { return this->center.x + this->halfWidth; }
+};
+
+// The tile contacts of an object, combined into the displacement that separates
+// the object from all of them
+// Each contact is resolved along the axis the object overlaps it the least on,
+// and only the deepest contact in each direction counts, so an object resting
+// on several tiles is only pushed out once
+struct ContactManifold {
+    int    count     = 0; // Contacts added since the last clear()
+    double pushLeft  = 0;
+    double pushRight = 0;
+    double pushUp    = 0;
+    double pushDown  = 0;
+
+    void clear();
+
+    // Add a contact between an object's bounds and a tile
+    // Ignored if the two aren't overlapping
+    void add(const AABB& box, const TileAABB& tile);
+
+    // The minimum translation vector on each axis
+    double getTranslationX() const;
+    double getTranslationY() const;
+};
+
+// The state of an object that isn't stored in its physics slot, other than its
+// state string, as plain data that can be copied byte for byte
+// Objects are referred to by their physics slot rather than by pointer
+struct ObjectState {
+    double  pivotX;
+    double  pivotY;
+    double  moveSpeed;
+    double  directionX;
+    double  directionY;
+    double  aimDirectionX;
+    double  aimDirectionY;
+    double  aimOriginX;
+    double  aimOriginY;
+    double  frictionAdd;   // Projectiles only
+    double  frictionMult;  // Projectiles only
+    int32_t owner;         // Projectiles only, slot of the owner or -1
+    int32_t lifespan;      // Projectiles only
+    uint8_t type;          // eObjTypes value
+    uint8_t directionType; // eDirTypes value
+    uint8_t walkType;      // eWalkTypes value
+    uint8_t dead;
+    uint8_t padding[4] = {0};
 };
 
 /* 
@@ -72,27 +128,42 @@ struct AABB : public AABBCommon {
  * object's hitbox on that axis.
  * 
  * The same logic is used for aimOriginX and aimOriginY.
+ *
+ * The object's bounding box, speed, weight, health and grounded state are
+ * stored in a slot of a PhysicsWorld, rather than in the object itself, so
+ * that they can be processed in bulk. The slot is released when the object is
+ * destroyed.
  */
-class GameObject {
+class GameObject : public QuadTreeItem {
+    friend class PhysicsWorld; // Keeps slot up to date
+
     protected:
-        AABB         bounds        = AABB({0, 0}, 8, 8);
+        PhysicsWorld* physics;
+        int           slot; // Index into physics's arrays
+
         double       pivotX        = 0;
         double       pivotY        = 0;
-        double       speedX        = 0;
-        double       speedY        = 0;
         double       moveSpeed     = 1;
         string       state         = "";
         vec2<double> direction     = DIR_NONE;
         eDirTypes    directionType = eDirTypes::none;
         eWalkTypes   walkType      = eWalkTypes::grounded;
-        double       weight        = 1; // Simple physics multiplier
         vec2<double> aimDirection  = DIR_NONE;
         double       aimOriginX    = 0;
         double       aimOriginY    = 0;
-        int          health        = 1;
-        bool         grounded      = false;
+        bool         dead          = false; // Waiting to be removed
+
+        GameObject(PhysicsWorld& physics);
     public:
-        AABB&        getBounds();
+        // Objects own their physics slot, so they can't be copied
+        GameObject(const GameObject&) = delete;
+        GameObject& operator=(const GameObject&) = delete;
+
+        PhysicsWorld& getPhysics() const;
+        int           getSlot() const;
+
+        // Built from the object's physics slot
+        AABB         getBounds() const;
         double       getPivotX() const;
         double       getPivotY() const;
         double       getSpeedX() const;
@@ -106,6 +177,7 @@ class GameObject {
         double       getAimOriginX() const;
         double       getAimOriginY() const;
         int          getHealth() const;
+        bool         isDead() const;
 
         // Get the values from the object's bounding box, but adjusted for the
         // pivot/aim origin
@@ -116,7 +188,8 @@ class GameObject {
         double getAimX() const;
         double getAimY() const;
 
-        // Same as getX and getY, but adjusted for the camera's position
+        // Same as getX and getY, but adjusted for the camera's position and
+        // interpolated between the last two physics states
         double getScreenX() const;
         double getScreenY() const;
 
@@ -135,13 +208,21 @@ class GameObject {
         // Check if the object is visible and should be rendered
         bool isVisible() const;
 
+        // Flag the object to be removed from the game at the end of the
+        // current phase, rather than right away
+        void markDead();
+
         // Move object regardless of collision rules
+        // The object is rendered at the new position right away, rather than
+        // being interpolated towards it
         void teleport(double x, double y);
 
         // Give the object X and Y speed
         void thrust(double addX, double addY);
 
-        // Move object while checking for collision at the target location
+        // Move object towards the target location, stopping at the first tile
+        // in the way and sliding along it for the rest of the movement
+        // Uses physics's tiles, and returns false if a tile was hit
         bool tryMove(double x, double y);
 
         // Move the object moveSpeed units toward the direction it's facing
@@ -153,20 +234,30 @@ class GameObject {
         // Change the object's aimDirection to aim at the given target
         void aimAt(vec2<double> target);
 
+        // Copy the object's state into a snapshot, or back from one
+        // Other objects are looked up by their slot in physics, so they must
+        // all have their slot back before the state of any of them is loaded
+        virtual void saveState(ObjectState& state) const;
+        virtual void loadState(const ObjectState& state);
+
         // Run the object's per-tick logic
         virtual void tick() {};
 
-        // Run the object's tile collision logic
-        virtual void onCollideTile(Tile* tile, vec2<int> intersection);
+        // Run the object's tile collision logic, given all of its current tile
+        // contacts
+        // By default, moves the object out of the tiles and stops it from
+        // moving further into them
+        virtual void onCollideTiles(const ContactManifold& contacts);
 
         // Pure virtual destructor to ensure this class is abstract
+        // Also releases the object's physics slot
         virtual ~GameObject() = 0;
 };
 
 // The player character
 class Player : public GameObject {
     public:
-        Player(double x, double y);
+        Player(PhysicsWorld& physics, double x, double y);
 
         eObjTypes getObjectType() override;
 };
@@ -175,17 +266,34 @@ class Player : public GameObject {
 // If owner is nullptr, it will be considered an environment projectile
 class Projectile : public GameObject {
     private:
-        GameObject* owner        = nullptr; // Who this projectile belongs to
-        int         lifespan     = -1; // Max. frames the object can exist for
-        double      frictionAdd  = 0.15;
-        double      frictionMult = 0.025; // Range: 0-1
-
-        Projectile();
+        // Who this projectile belongs to, looked up in ownerPool so that the
+        // owner being destroyed is noticed, even once its slot is reused
+        const ObjectPool<Player>* ownerPool;
+        PoolHandle                owner;
+
+        int    lifespan     = -1; // Max. frames the object can exist for
+        double frictionAdd  = 0.15;
+        double frictionMult = 0.025; // Range: 0-1
     public:
-        Projectile(GameObject* owner, int lifespan, double width, double height);
+        // owner must be nullptr or have been created from ownerPool
+        Projectile(
+            PhysicsWorld&             physics,
+            const ObjectPool<Player>& ownerPool,
+            Player*                   owner,
+            int                       lifespan,
+            double                    width,
+            double                    height
+        );
 
         eObjTypes getObjectType() override;
 
+        // The player who fired this projectile
+        // Returns nullptr if it has no owner, or they've been destroyed since
+        Player* getOwner() const;
+
+        void saveState(ObjectState& state) const override;
+        void loadState(const ObjectState& state) override;
+
         void tick() override;
 };
 
@@ -0,0 +1,91 @@
+#include "pacer.hpp"
+
+#include <chrono>
+#include <thread>
+
+using std::chrono::duration, std::chrono::duration_cast;
+
+/* -- FramePacer -- */
+
+// Constructors
+FramePacer::FramePacer(double targetRate, double spinThreshold)
+    : targetRate(targetRate),
+      spinThreshold(spinThreshold) {}
+
+// Getters
+double FramePacer::getTargetRate() const    { return this->targetRate; }
+double FramePacer::getSpinThreshold() const { return this->spinThreshold; }
+double FramePacer::getWorkTime() const      { return this->workTime; }
+double FramePacer::getIdleTime() const      { return this->idleTime; }
+int    FramePacer::getFrameCount() const    { return this->frameCount; }
+
+double FramePacer::getIdleRatio() const {
+    double total = this->workTime + this->idleTime;
+
+    return (total > 0) ? this->idleTime/total : 0;
+}
+
+// Setters
+void FramePacer::setTargetRate(double targetRate) {
+    this->targetRate = targetRate;
+}
+void FramePacer::setSpinThreshold(double spinThreshold) {
+    this->spinThreshold = spinThreshold;
+}
+
+// Other methods
+double FramePacer::waitForNextFrame() {
+    Clock::time_point workEnd = Clock::now();
+    Clock::duration   period  = duration_cast<Clock::duration>(
+                                    duration<double>(1/this->targetRate)
+                                );
+
+    if (!this->started) {
+        // Nothing to wait for before the first frame, which counts as a whole
+        // frame so that the caller has something to simulate before it's
+        // first drawn
+        this->started = true;
+        this->lastFrame = workEnd;
+        this->nextFrame = workEnd + period;
+        return 1/this->targetRate;
+    }
+
+    Clock::duration spin = duration_cast<Clock::duration>(
+                               duration<double>(this->spinThreshold)
+                           );
+
+    // Sleep through most of the wait, then spin through the rest
+    if (this->nextFrame - workEnd > spin) {
+        std::this_thread::sleep_for(this->nextFrame - workEnd - spin);
+    }
+
+    Clock::time_point now = Clock::now();
+
+    while (now < this->nextFrame) {
+        now = Clock::now();
+    }
+
+    this->workTime += duration<double>(workEnd - this->lastFrame).count();
+    this->idleTime += duration<double>(now - workEnd).count();
+    this->frameCount++;
+
+    double delta = duration<double>(now - this->lastFrame).count();
+
+    // If the last frame ran over its budget, schedule from now rather than
+    // trying to catch up with a burst of short frames
+    this->nextFrame += period;
+
+    if (this->nextFrame < now) {
+        this->nextFrame = now + period;
+    }
+
+    this->lastFrame = now;
+
+    return delta;
+}
+
+void FramePacer::resetStats() {
+    this->workTime = 0;
+    this->idleTime = 0;
+    this->frameCount = 0;
+}
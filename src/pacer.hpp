@@ -0,0 +1,57 @@
+// Frame rate limiting
+
+#ifndef PACER_HPP
+#define PACER_HPP
+
+#include <chrono>
+
+/*
+ * Waits out the rest of each frame's time budget, to keep a steady frame rate
+ * without keeping a CPU core busy
+ *
+ * OS sleeps can overshoot by a millisecond or more, so the pacer only sleeps
+ * until spinThreshold seconds are left before the next frame is due, then
+ * spins for the rest of the wait.
+ *
+ * Also keeps track of how much time was spent working (between calls to
+ * waitForNextFrame) and idling (inside of it), until resetStats is called.
+ */
+class FramePacer {
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        double targetRate;    // Frames per second
+        double spinThreshold; // In seconds
+
+        Clock::time_point lastFrame;  // When the last frame started
+        Clock::time_point nextFrame;  // When the next frame is due
+        bool              started = false;
+
+        double workTime   = 0; // In seconds
+        double idleTime   = 0;
+        int    frameCount = 0;
+    public:
+        FramePacer(double targetRate = 60, double spinThreshold = 0.001);
+
+        double getTargetRate() const;
+        double getSpinThreshold() const;
+        double getWorkTime() const;
+        double getIdleTime() const;
+        int    getFrameCount() const;
+
+        // Fraction of the time that was spent idling, from 0 to 1
+        double getIdleRatio() const;
+
+        void setTargetRate(double targetRate);
+        void setSpinThreshold(double spinThreshold);
+
+        // Wait until the next frame is due
+        // Returns the time since the previous frame started, in seconds, or
+        // one frame's worth of time on the first call
+        double waitForNextFrame();
+
+        // Reset the work and idle times and the frame count
+        void resetStats();
+};
+
+#endif
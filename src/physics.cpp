@@ -0,0 +1,109 @@
+#include "physics.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "objects.hpp"
+
+using std::abs, std::min;
+using std::vector;
+
+/* -- PhysicsWorld -- */
+
+// Getters
+int PhysicsWorld::size() const { return this->owners.size(); }
+
+// Other methods
+int PhysicsWorld::add(GameObject* owner) {
+    this->centerX.push_back(0);
+    this->centerY.push_back(0);
+    this->lastCenterX.push_back(0);
+    this->lastCenterY.push_back(0);
+    this->halfWidth.push_back(8);
+    this->halfHeight.push_back(8);
+    this->speedX.push_back(0);
+    this->speedY.push_back(0);
+    this->weight.push_back(1);
+    this->health.push_back(1);
+    this->grounded.push_back(false);
+    this->owners.push_back(owner);
+
+    return this->owners.size() - 1;
+}
+
+void PhysicsWorld::remove(int slot) {
+    int last = this->owners.size() - 1;
+
+    if (slot != last) {
+        this->centerX[slot]     = this->centerX[last];
+        this->centerY[slot]     = this->centerY[last];
+        this->lastCenterX[slot] = this->lastCenterX[last];
+        this->lastCenterY[slot] = this->lastCenterY[last];
+        this->halfWidth[slot]   = this->halfWidth[last];
+        this->halfHeight[slot]  = this->halfHeight[last];
+        this->speedX[slot]      = this->speedX[last];
+        this->speedY[slot]      = this->speedY[last];
+        this->weight[slot]      = this->weight[last];
+        this->health[slot]      = this->health[last];
+        this->grounded[slot]    = this->grounded[last];
+        this->owners[slot]      = this->owners[last];
+
+        this->owners[slot]->slot = slot;
+    }
+
+    this->centerX.pop_back();
+    this->centerY.pop_back();
+    this->lastCenterX.pop_back();
+    this->lastCenterY.pop_back();
+    this->halfWidth.pop_back();
+    this->halfHeight.pop_back();
+    this->speedX.pop_back();
+    this->speedY.pop_back();
+    this->weight.pop_back();
+    this->health.pop_back();
+    this->grounded.pop_back();
+    this->owners.pop_back();
+}
+
+void PhysicsWorld::reassign(const vector<GameObject*>& owners) {
+    this->owners = owners;
+
+    for (int i = 0; i < this->size(); i++) {
+        this->owners[i]->slot = i;
+    }
+}
+
+void PhysicsWorld::applyGravity() {
+    int count = this->size();
+
+    for (int i = 0; i < count; i++) {
+        this->speedY[i] += (abs(this->speedY[i])*GRAV_MULT + GRAV_ADD)*this->weight[i];
+
+        // Cap falling speed
+        this->speedY[i] = min(this->speedY[i], GRAV_CAP*this->weight[i]);
+    }
+}
+
+void PhysicsWorld::integrate() {
+    int count = this->size();
+
+    for (int i = 0; i < count; i++) {
+        this->lastCenterX[i] = this->centerX[i];
+        this->lastCenterY[i] = this->centerY[i];
+
+        if (this->needsSweep(i)) continue;
+
+        this->centerX[i] += this->speedX[i];
+        this->centerY[i] += this->speedY[i];
+    }
+}
+
+bool PhysicsWorld::hasMoved(int slot) const {
+    return this->centerX[slot] != this->lastCenterX[slot]
+        || this->centerY[slot] != this->lastCenterY[slot];
+}
+bool PhysicsWorld::needsSweep(int slot) const {
+    return abs(this->speedX[slot]) > this->halfWidth[slot]
+        || abs(this->speedY[slot]) > this->halfHeight[slot];
+}
@@ -0,0 +1,89 @@
+// Storage for the physics state of game objects
+
+#ifndef PHYSICS_HPP
+#define PHYSICS_HPP
+
+#include <cstdint>
+#include <vector>
+
+using std::vector;
+
+// Usage: speedY += speedY*GRAV_MULT + GRAV_ADD
+const double GRAV_ADD = 0.3;
+const double GRAV_MULT = 0.03;
+const double GRAV_CAP = 15;
+
+class GameObject;
+class StaticTileIndex;
+class StreamingTileIndex;
+
+/*
+ * Holds the physics state that's accessed every tick (position, size, speed,
+ * etc.) for a set of game objects, as a structure of arrays
+ *
+ * Every GameObject owns one slot, i.e. one index into all of the arrays, for
+ * as long as it exists. The per-tick physics passes then go through each array
+ * linearly instead of following pointers to each object.
+ *
+ * Removing a slot moves the last slot into its place, so slots aren't stable:
+ * refer to objects through their GameObject instead.
+ */
+class PhysicsWorld {
+    public:
+        vector<double>      centerX;
+        vector<double>      centerY;
+        vector<double>      lastCenterX; // Center before the last integrate()
+        vector<double>      lastCenterY;
+        vector<double>      halfWidth;
+        vector<double>      halfHeight;
+        vector<double>      speedX;
+        vector<double>      speedY;
+        vector<double>      weight; // Simple physics multiplier
+        vector<int>         health;
+        vector<uint8_t>     grounded;
+        vector<GameObject*> owners; // The object each slot belongs to
+
+        // How far between the last two physics states objects should be
+        // rendered, from 0 (lastCenter) to 1 (center)
+        double renderAlpha = 1;
+
+        // Tiles that objects moving with GameObject::tryMove can't pass
+        // through, if any
+        // tileStream is used instead of tiles when it's set
+        const StaticTileIndex*    tiles      = nullptr;
+        const StreamingTileIndex* tileStream = nullptr;
+
+        // Add a slot for the given object, with default values
+        // Returns the new slot's index
+        int add(GameObject* owner);
+
+        // Remove a slot, moving the last slot into its place
+        // The owner of the moved slot is updated accordingly
+        void remove(int slot);
+
+        // Give each object in owners the slot at its index
+        // owners must hold the same objects as the slots do, in any order
+        // The arrays' values aren't moved along with their objects, so they
+        // should all be overwritten afterwards
+        void reassign(const vector<GameObject*>& owners);
+
+        int size() const;
+
+        // Pull all objects down based on their weight, capping falling speed
+        void applyGravity();
+
+        // Displace all objects based on their speed
+        // Objects that need a swept test are skipped, and should be moved with
+        // GameObject::tryMove instead
+        void integrate();
+
+        // Check if the object in the given slot moves far enough in a tick
+        // that it could skip past tiles, rather than overlap them
+        bool needsSweep(int slot) const;
+
+        // Check if the object in the given slot has moved since the last call
+        // to integrate()
+        bool hasMoved(int slot) const;
+};
+
+#endif
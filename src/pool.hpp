@@ -0,0 +1,83 @@
+// Fixed-size slab allocation for short-lived objects
+
+#ifndef POOL_HPP
+#define POOL_HPP
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+using std::unique_ptr;
+using std::vector;
+
+// Refers to an object in an ObjectPool
+// Unlike a pointer, it can be checked for whether the object still exists,
+// even after its memory has been reused for another object
+struct PoolHandle {
+    int      index      = -1;
+    uint32_t generation = 0;
+};
+
+/*
+ * Allocates objects of type T from fixed-size slabs, rather than one at a time
+ * from the heap
+ *
+ * Destroyed objects leave their slot on a free list, which is threaded through
+ * the slots themselves, and the next created object takes the most recently
+ * freed slot. Slabs are never freed or moved while the pool exists, so once
+ * the pool has grown large enough, creating and destroying objects costs O(1)
+ * and never allocates.
+ */
+template <typename T>
+class ObjectPool {
+    private:
+        static const int SLAB_SIZE = 256; // Slots per slab
+
+        // Holds either an object or, while unused, a link in the free list
+        // storage must be the first member, so that an object's address is
+        // also its slot's address
+        struct Slot {
+            alignas(T) unsigned char storage[sizeof(T)];
+            int      index;          // This slot's index within the pool
+            int      nextFree;       // Next slot in the free list, or -1
+            uint32_t generation = 0; // Incremented every time it's freed
+            bool     alive      = false;
+        };
+
+        vector<unique_ptr<Slot[]>> slabs;
+        int                        firstFree = -1; // Head of the free list
+        int                        liveCount = 0;
+
+        Slot& getSlot(int index) const;
+
+        // Allocate another slab and add all its slots to the free list
+        void grow();
+    public:
+        ObjectPool() = default;
+        ObjectPool(const ObjectPool&) = delete;
+        ObjectPool& operator=(const ObjectPool&) = delete;
+
+        // Destroys all objects which are still alive
+        ~ObjectPool();
+
+        // Construct an object in a free slot, growing the pool if there's none
+        template <typename... Args>
+        T* create(Args&&... args);
+
+        // Destroy an object that was created by this pool, freeing its slot
+        void destroy(T* object);
+
+        // Get a handle for an object that was created by this pool
+        PoolHandle getHandle(T* object) const;
+
+        // Get the object a handle refers to
+        // Returns nullptr if the object has been destroyed since
+        T* get(PoolHandle handle) const;
+
+        int getLiveCount() const;
+        int getCapacity() const;
+};
+
+#include "pool.tpp"
+
+#endif
@@ -0,0 +1,101 @@
+#include "pool.hpp"
+
+#include <new>
+#include <utility>
+
+/* -- ObjectPool -- */
+
+// Destructors
+template <typename T>
+ObjectPool<T>::~ObjectPool() {
+    for (int i = 0; i < this->getCapacity(); i++) {
+        Slot& slot = this->getSlot(i);
+
+        if (slot.alive) {
+            reinterpret_cast<T*>(slot.storage)->~T();
+        }
+    }
+}
+
+// Getters
+template <typename T>
+int ObjectPool<T>::getLiveCount() const { return this->liveCount; }
+template <typename T>
+int ObjectPool<T>::getCapacity() const  { return this->slabs.size()*SLAB_SIZE; }
+
+template <typename T>
+typename ObjectPool<T>::Slot& ObjectPool<T>::getSlot(int index) const {
+    return this->slabs[index/SLAB_SIZE][index%SLAB_SIZE];
+}
+
+// Other methods
+template <typename T>
+void ObjectPool<T>::grow() {
+    int firstIndex = this->getCapacity();
+
+    this->slabs.emplace_back(new Slot[SLAB_SIZE]);
+
+    // Link the new slots in order, in front of the existing free list
+    for (int i = SLAB_SIZE - 1; i >= 0; i--) {
+        Slot& slot = this->slabs.back()[i];
+
+        slot.index = firstIndex + i;
+        slot.nextFree = this->firstFree;
+        this->firstFree = slot.index;
+    }
+}
+
+template <typename T>
+template <typename... Args>
+T* ObjectPool<T>::create(Args&&... args) {
+    if (this->firstFree == -1) {
+        this->grow();
+    }
+
+    Slot& slot = this->getSlot(this->firstFree);
+
+    // Construct first, so that the slot stays free if the constructor throws
+    T* object = new (slot.storage) T(std::forward<Args>(args)...);
+
+    this->firstFree = slot.nextFree;
+    slot.nextFree = -1;
+    slot.alive = true;
+    this->liveCount++;
+
+    return object;
+}
+
+template <typename T>
+void ObjectPool<T>::destroy(T* object) {
+    Slot& slot = *reinterpret_cast<Slot*>(object);
+
+    object->~T();
+
+    slot.alive = false;
+    slot.generation++;
+    slot.nextFree = this->firstFree;
+    this->firstFree = slot.index;
+    this->liveCount--;
+}
+
+template <typename T>
+PoolHandle ObjectPool<T>::getHandle(T* object) const {
+    Slot& slot = *reinterpret_cast<Slot*>(object);
+
+    return {slot.index, slot.generation};
+}
+
+template <typename T>
+T* ObjectPool<T>::get(PoolHandle handle) const {
+    if (handle.index < 0 || handle.index >= this->getCapacity()) {
+        return nullptr;
+    }
+
+    Slot& slot = this->getSlot(handle.index);
+
+    if (!slot.alive || slot.generation != handle.generation) {
+        return nullptr;
+    }
+
+    return reinterpret_cast<T*>(slot.storage);
+}
@@ -0,0 +1,194 @@
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+using std::map;
+using std::setw;
+using std::sort;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+using Clock = std::chrono::steady_clock;
+
+bool profilerEnabled = false;
+
+// Event times are relative to this, so they fit comfortably in the trace
+const Clock::time_point profilerEpoch = Clock::now();
+
+// Buffers of every thread that has recorded an event
+// The mutex is only locked the first time each thread records something
+vector<unique_ptr<ProfileBuffer>> profileBuffers;
+std::mutex                        profileBuffersMutex;
+
+thread_local ProfileBuffer* threadProfileBuffer = nullptr;
+
+static int64_t profilerNow() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        Clock::now() - profilerEpoch
+    ).count();
+}
+
+static ProfileBuffer& getThreadProfileBuffer() {
+    if (threadProfileBuffer == nullptr) {
+        std::lock_guard<std::mutex> lock(profileBuffersMutex);
+
+        profileBuffers.emplace_back(new ProfileBuffer(profileBuffers.size()));
+        threadProfileBuffer = profileBuffers.back().get();
+    }
+
+    return *threadProfileBuffer;
+}
+
+// Gather every thread's events, sorted by start time
+static vector<std::pair<int, ProfileEvent>> collectProfile() {
+    vector<std::pair<int, ProfileEvent>> all;
+    vector<ProfileEvent>                 events;
+
+    std::lock_guard<std::mutex> lock(profileBuffersMutex);
+
+    for (auto& buffer : profileBuffers) {
+        events.clear();
+        buffer->collect(events);
+
+        for (ProfileEvent& event : events) {
+            all.push_back({buffer->getThreadIndex(), event});
+        }
+    }
+
+    sort(all.begin(), all.end(), [](auto& a, auto& b) {
+        return a.second.start < b.second.start;
+    });
+
+    return all;
+}
+
+/* -- ProfileBuffer -- */
+
+// Constructors
+ProfileBuffer::ProfileBuffer(int threadIndex)
+    : threadIndex(threadIndex) {}
+
+// Getters
+int ProfileBuffer::getThreadIndex() const { return this->threadIndex; }
+
+// Other methods
+void ProfileBuffer::record(const char* name, int64_t start, int64_t duration) {
+    uint64_t index = this->written.load(std::memory_order_relaxed);
+
+    this->events[index % ProfileBuffer::CAPACITY] = {name, start, duration};
+
+    // Publish the event only once it's been fully written
+    this->written.store(index + 1, std::memory_order_release);
+}
+
+void ProfileBuffer::collect(vector<ProfileEvent>& acc) const {
+    uint64_t end   = this->written.load(std::memory_order_acquire);
+    uint64_t begin = (end > ProfileBuffer::CAPACITY) ? end - ProfileBuffer::CAPACITY : 0;
+
+    for (uint64_t i = begin; i < end; i++) {
+        acc.push_back(this->events[i % ProfileBuffer::CAPACITY]);
+    }
+}
+
+void ProfileBuffer::clear() {
+    this->written.store(0, std::memory_order_release);
+}
+
+/* -- ScopedTimer -- */
+
+// Constructors
+ScopedTimer::ScopedTimer(const char* name)
+    : name(name) {
+    if (profilerEnabled) {
+        this->start = profilerNow();
+    }
+}
+
+// Destructors
+ScopedTimer::~ScopedTimer() {
+    if (this->start == -1) return;
+
+    getThreadProfileBuffer().record(this->name, this->start, profilerNow() - this->start);
+}
+
+/* -- Utility methods -- */
+
+bool exportChromeTrace(string path) {
+    std::ofstream file(path);
+
+    if (!file) return false;
+
+    auto events = collectProfile();
+
+    // Complete ("X") events, with times in microseconds
+    file << "{\"traceEvents\":[\n";
+
+    for (size_t i = 0; i < events.size(); i++) {
+        const ProfileEvent& event = events[i].second;
+
+        file << "{\"name\":\"" << event.name
+             << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << events[i].first
+             << ",\"ts\":"  << event.start/1000.0
+             << ",\"dur\":" << event.duration/1000.0
+             << ((i + 1 < events.size()) ? "},\n" : "}\n");
+    }
+
+    file << "],\"displayTimeUnit\":\"ms\"}\n";
+
+    return file.good();
+}
+
+void printProfileSummary(ostream& out) {
+    map<string, vector<int64_t>> durations;
+
+    for (auto& entry : collectProfile()) {
+        durations[entry.second.name].push_back(entry.second.duration);
+    }
+
+    out << std::left << setw(20) << "phase" << std::right
+        << setw(10) << "count"
+        << setw(12) << "p50 ms"
+        << setw(12) << "p90 ms"
+        << setw(12) << "p99 ms"
+        << setw(12) << "max ms" << '\n';
+
+    for (auto& phase : durations) {
+        vector<int64_t>& times = phase.second;
+
+        sort(times.begin(), times.end());
+
+        auto percentile = [&times](double p) {
+            return times[static_cast<int>(p*(times.size() - 1))]/1e6;
+        };
+
+        out << std::left << setw(20) << phase.first << std::right
+            << setw(10) << times.size()
+            << std::fixed << std::setprecision(3)
+            << setw(12) << percentile(0.5)
+            << setw(12) << percentile(0.9)
+            << setw(12) << percentile(0.99)
+            << setw(12) << times.back()/1e6 << '\n'
+            << std::defaultfloat;
+    }
+}
+
+void clearProfile() {
+    std::lock_guard<std::mutex> lock(profileBuffersMutex);
+
+    for (auto& buffer : profileBuffers) {
+        buffer->clear();
+    }
+}
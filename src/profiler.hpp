@@ -0,0 +1,88 @@
+// Scoped timers for profiling the phases of a frame
+
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+using std::ostream;
+using std::string;
+using std::vector;
+
+// A timed scope, with times in nanoseconds since the profiler started
+struct ProfileEvent {
+    const char* name;
+    int64_t     start;
+    int64_t     duration;
+};
+
+/*
+ * Fixed-size ring buffer of the events recorded by a single thread
+ *
+ * Only the owning thread writes to it, so recording doesn't need any locks.
+ * Once full, the oldest events are overwritten.
+ */
+class ProfileBuffer {
+    public:
+        static const int CAPACITY = 1 << 16;
+    private:
+        ProfileEvent          events[ProfileBuffer::CAPACITY];
+        std::atomic<uint64_t> written{0}; // Events recorded since clear()
+        int                   threadIndex; // Order in which threads started
+                                           // recording
+    public:
+        ProfileBuffer(int threadIndex);
+
+        int getThreadIndex() const;
+
+        // Must only be called by the thread that owns the buffer
+        void record(const char* name, int64_t start, int64_t duration);
+
+        // Append the events still in the buffer to acc, oldest first
+        void collect(vector<ProfileEvent>& acc) const;
+
+        void clear();
+};
+
+/*
+ * Records the time between its construction and destruction as an event
+ * named after the given string literal, in the current thread's buffer
+ *
+ * Does nothing besides checking profilerEnabled while the profiler is
+ * disabled.
+ */
+class ScopedTimer {
+    private:
+        const char* name;
+        int64_t     start = -1; // -1 if the profiler was disabled
+    public:
+        ScopedTimer(const char* name);
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+        ~ScopedTimer();
+};
+
+// Whether or not ScopedTimers should record anything
+extern bool profilerEnabled;
+
+// Write all recorded events to a file, in the Chrome trace event format, which
+// can be opened with chrome://tracing or Perfetto
+// Returns false if the file couldn't be written
+// Events must not be recorded while this runs
+extern bool exportChromeTrace(string path);
+
+// Print the number of events and their 50th, 90th and 99th percentile and
+// maximum durations, for each event name
+// Events must not be recorded while this runs
+extern void printProfileSummary(ostream& out);
+
+// Discard all recorded events
+// Events must not be recorded while this runs
+extern void clearProfile();
+
+#endif
@@ -3,13 +3,13 @@
 #ifndef QUADTREE_HPP
 #define QUADTREE_HPP
 
-#include <array>
+#include <cstdint>
 #include <vector>
 
 #include "objects.hpp"
+#include "treeitem.hpp"
 #include "util.hpp"
 
-using std::array;
 using std::vector;
 
 const int QUAD_NW = 0;
@@ -17,50 +17,182 @@ const int QUAD_NE = 1;
 const int QUAD_SW = 2;
 const int QUAD_SE = 3;
 
-// A quadtree for holding instances of AABBCommon
-// Can either be the root node of a quadtree or a quadrant (a nested quadtree)
+/*
+ * A quadtree for holding instances of AABBCommon
+ * Items must derive from QuadTreeItem, which holds the node they're in
+ *
+ * All nodes of the tree (the root node and its quadrants, recursively) are
+ * stored contiguously in a node pool, and reference their quadrants by index
+ * rather than by pointer. The 4 quadrants of a node are always stored next to
+ * each other, in NW, NE, SW and SE order.
+ *
+ * Clearing the tree only resets the pool, so nodes (and their item lists) are
+ * reused by the next round of insertions instead of being freed and allocated
+ * again.
+ *
+ * Items that move can be relocated with update() instead of rebuilding the
+ * whole tree. Quadrants which end up empty are only merged back into their
+ * parent node once prune() is called.
+ */
 template <typename T>
 class QuadTree {
+    public:
+        // A node of the tree, either the root node or a quadrant
+        struct Node {
+            int        level;
+            AABB       bounds;
+            vector<T*> items;
+            int        firstQuad = -1; // Pool index of the NW quadrant, or -1
+            int        parent    = -1; // Pool index of the parent node, or -1
+            int        count     = 0;  // Items in this node and its quadrants
+
+            Node(int level, AABB bounds);
+        };
+
+        // Shape of the tree, for detecting when items pile up in large nodes
+        struct Stats {
+            int nodes      = 0; // Nodes reachable from the root
+            int depth      = 0; // Deepest level of any reachable node
+            int innerItems = 0; // Items held by nodes that have quadrants
+        };
     private:
         static const int BUCKET_CAPACITY = 4;
         static const int MAX_LEVELS = 10;
 
-        int                 level;
-        AABB                bounds;
-        vector<T*>          items;
-        array<QuadTree*, 4> quads   = {nullptr}; // NW, NE, SW and SE quadrants
-    public:
-        QuadTree(int level, AABB bounds);
+        vector<Node> nodes;         // Node pool, root is at 0
+        int          nodeCount = 1; // Nodes past this are unused
+        vector<int>  freeQuads;     // Released quadrant sets
 
-        AABB&               getBounds();
-        vector<T*>          getItems() const;
-        array<QuadTree*, 4> getQuadrants() const;
+        // Items are only in the tree if their QuadTreeItem has this
+        // generation, which is replaced by clear(), so that clearing doesn't
+        // need to visit the items
+        // Removed items are given a generation of -1
+        int64_t generation;
 
-        // Clears the items of this node and clear its existing quadrants
-        // recursively
-        void clear();
+        // An item being placed by rebuild(), along with its bounds, so that
+        // they're only read from the item once
+        struct BuildItem {
+            T*     item;
+            int    order; // Index of the item in the list given to rebuild()
+            double topY;
+            double bottomY;
+            double leftX;
+            double rightX;
+
+            double getTopY() const    { return this->topY; }
+            double getBottomY() const { return this->bottomY; }
+            double getLeftX() const   { return this->leftX; }
+            double getRightX() const  { return this->rightX; }
+        };
+
+        // Scratch space for rebuild(), kept so that rebuilding doesn't allocate
+        vector<BuildItem> buildItems;
+        vector<BuildItem> buildSorted;
+        vector<int>       buildQuads;
+        vector<int>       buildNodes; // Node of each item, by order, or -1
 
-        // Generate the NW, NE, SW and SE quadrants, "splitting" this node
-        void subdivide();
+        // Generate the NW, NE, SW and SE quadrants of the given node,
+        // "splitting" it
+        // The quadrants will reuse nodes from the pool if there are any left
+        void subdivide(int index);
 
-        // Find the index of whichever quadrant could hold this bounding box
+        // Check if the given box fully fits inside the bounds of the given node
+        template <typename B>
+        bool fitsInside(int index, const B& box) const;
+
+        // Add delta to the item count of the given node and all its ancestors
+        void adjustCounts(int index, int delta);
+
+        // Detach an item from the node it was inserted into
+        // Returns the index of that node, or -1 if the item isn't in the tree
+        int detach(T* item);
+
+        // Merge back the quadrants of the given node, recursively, if they
+        // hold no items
+        void prune(int index);
+
+        // Return the quadrants of the given node (and theirs, recursively) to
+        // the pool
+        void release(int index);
+
+        // Find the index (QUAD_* constant) of whichever quadrant of the given
+        // node could hold this bounding box
         // Returns -1 on error or if the box can't fully fit into any quadrant
-        // PS: will *not* check if the quadrants actually exist! (i.e. if this
+        // PS: will *not* check if the quadrants actually exist! (i.e. if the
         // node has been subdivided)
-        int findFittingQuadrant(AABBCommon& box) const;
+        template <typename B>
+        int findFittingQuadrant(int index, const B& box) const;
+
+        // Place an item into the given node's items, and remember it's there
+        void place(int index, T* item);
 
-        // Attempt to insert an item into this node
-        // If necessary, this node will be subdivided and all its items will
+        // Attempt to insert an item into the given node
+        // If necessary, the node will be subdivided and all its items will
         // try to fit into a quadrant
+        void insert(int index, T* item);
+
+        // Fill the given empty node with buildItems[begin, end), which must
+        // all fit inside it, subdividing it recursively
+        // The node each item ends up in is written to buildNodes
+        void build(int index, int begin, int end);
+
+        // Recursively visit items in the given node which could intersect
+        // the given box
+        // Returns false if visit asked to stop early
+        template <typename B, typename F>
+        bool forEachPossibleCollision(int index, const B& box, F& visit) const;
+    public:
+        QuadTree(AABB bounds);
+
+        AABB&       getBounds();
+        const Node& getNode(int index) const; // The root node is at index 0
+
+        // Walks the whole tree, so it's not meant to be called every query
+        Stats getStats() const;
+
+        // Clears the items of all nodes and removes all quadrants
+        // The nodes are kept in the pool, to be reused by later insertions
+        void clear();
+
+        // Attempt to insert an item into the tree
+        // PS: the item must not be in the tree already, use update() instead
         void insert(T* item);
 
+        // Replace all items in the tree with the given ones, placing each item
+        // directly into its final node rather than inserting them one by one
+        // The tree ends up with the same nodes as inserting the items one by
+        // one into a cleared tree would give it
+        void rebuild(const vector<T*>& items);
+
+        // Relocate an item whose bounding box has changed
+        // The item is only moved if it no longer fits inside its current node,
+        // and is inserted if it wasn't in the tree yet
+        void update(T* item);
+
+        // Remove an item from the tree
+        // Returns false if the item wasn't in the tree
+        bool remove(T* item);
+
+        // Merge back all quadrants that were left empty by update() and
+        // remove() calls
+        void prune();
+
+        // Recursively look for items which intersect the given box, calling
+        // visit(T* item) for each of them
+        // The search stops as soon as visit returns false, in which case this
+        // also returns false
+        // Does not allocate or copy anything, and box's getters are resolved
+        // at compile time (see intersectBoxes)
+        template <typename B, typename F>
+        bool forEachPossibleCollision(const B& box, F visit) const;
+
         // Recursively look for items which intersect the given box
-        // Returns a list of matched items
-        // PS: do *not* specify a value for acc when calling!
-        vector<T*> findPossibleCollisions(
-            AABBCommon& box,
-            vector<T*> acc = {}
-        ) const;
+        // Matched items are appended to acc, which is not cleared beforehand,
+        // so that a single buffer can be reused across queries
+        void findPossibleCollisions(AABBCommon& box, vector<T*>& acc) const;
+
+        // Same as above, but returns a new list of matched items
+        vector<T*> findPossibleCollisions(AABBCommon& box) const;
 };
 
 #include "quadtree.tpp"
@@ -1,86 +1,205 @@
 #include "quadtree.hpp"
 
-#include <array>
+#include <algorithm>
+#include <cstddef>
 #include <vector>
 
+#include "metrics.hpp"
 #include "objects.hpp"
 
-using std::array;
 using std::vector;
 
-/* -- QuadTree -- */
+/* -- QuadTree::Node -- */
 
 // Constructors
 template<typename T>
-QuadTree<T>::QuadTree(int level, AABB bounds)
+QuadTree<T>::Node::Node(int level, AABB bounds)
     : level(level),
       bounds(bounds) {}
 
+/* -- QuadTree -- */
+
+// Constructors
+template<typename T>
+QuadTree<T>::QuadTree(AABB bounds)
+    : generation(++quadTreeGenerations) {
+    this->nodes.emplace_back(0, bounds);
+}
+
 // Getters
 template<typename T>
-AABB&                  QuadTree<T>::getBounds()          { return this->bounds; }
+AABB& QuadTree<T>::getBounds() { return this->nodes[0].bounds; }
 template<typename T>
-vector<T*>             QuadTree<T>::getItems() const     { return this->items; }
+const typename QuadTree<T>::Node& QuadTree<T>::getNode(int index) const {
+    return this->nodes[index];
+}
 template<typename T>
-array<QuadTree<T>*, 4> QuadTree<T>::getQuadrants() const { return this->quads; }
+typename QuadTree<T>::Stats QuadTree<T>::getStats() const {
+    Stats stats;
+    vector<int> pending = {0};
+
+    while (!pending.empty()) {
+        const Node& node = this->nodes[pending.back()];
+        pending.pop_back();
+
+        stats.nodes++;
+        stats.depth = std::max(stats.depth, node.level);
+
+        if (node.firstQuad != -1) {
+            stats.innerItems += node.items.size();
+
+            for (int i = 0; i < 4; i++) {
+                pending.push_back(node.firstQuad + i);
+            }
+        }
+    }
+
+    return stats;
+}
 
 // Other methods
 template<typename T>
 void QuadTree<T>::clear() {
-    // Delete the item pointers in this node
+    // Delete the item pointers in the root node
     // Will NOT free the items that the pointers point to
-    this->items.clear();
-
-    // Recursively delete all items contained in this node's quadrants
-    // Also delete the quadrants themselves
-    if (this->quads[0] != nullptr) {
-        for (int i = 0; i < this->quads.size(); i++) {
-            this->quads[i]->clear();
-            delete(this->quads[i]);
-            this->quads[i] = nullptr;
+    this->nodes[0].items.clear();
+    this->nodes[0].firstQuad = -1;
+    this->nodes[0].count = 0;
+
+    // Every other node is now considered unused, and will have its items
+    // cleared once it's reused by subdivide()
+    this->nodeCount = 1;
+    this->freeQuads.clear();
+
+    // Invalidate the locations of all items, without visiting them
+    this->generation = ++quadTreeGenerations;
+}
+
+template<typename T>
+void QuadTree<T>::subdivide(int index) {
+    int    level      = this->nodes[index].level + 1;
+    AABB   bounds     = this->nodes[index].bounds;
+    double halfWidth  = bounds.halfWidth/2;
+    double halfHeight = bounds.halfHeight/2;
+
+    vec2<double> centers[4] = {
+        {bounds.center.x - halfWidth, bounds.center.y - halfHeight}, // NW
+        {bounds.center.x + halfWidth, bounds.center.y - halfHeight}, // NE
+        {bounds.center.x - halfWidth, bounds.center.y + halfHeight}, // SW
+        {bounds.center.x + halfWidth, bounds.center.y + halfHeight}  // SE
+    };
+
+    // Prefer quadrants released by prune() over taking new ones from the pool
+    int firstQuad;
+
+    if (!this->freeQuads.empty()) {
+        firstQuad = this->freeQuads.back();
+        this->freeQuads.pop_back();
+    } else {
+        firstQuad = this->nodeCount;
+        this->nodeCount += 4;
+    }
+
+    for (int i = 0; i < 4; i++) {
+        AABB quadBounds = AABB(centers[i], halfWidth, halfHeight);
+
+        if (static_cast<size_t>(firstQuad + i) < this->nodes.size()) {
+            // Reuse a node left over from before the last clear()
+            Node& quad = this->nodes[firstQuad + i];
+
+            quad.level = level;
+            quad.bounds = quadBounds;
+            quad.items.clear();
+            quad.firstQuad = -1;
+            quad.count = 0;
+        } else {
+            // Pool hasn't grown this large yet
+            // Note that this may invalidate references to existing nodes
+            this->nodes.emplace_back(level, quadBounds);
         }
+
+        this->nodes[firstQuad + i].parent = index;
     }
+
+    this->nodes[index].firstQuad = firstQuad;
 }
 
 template<typename T>
-void QuadTree<T>::subdivide() {
-    vec2<double> nwCenter = {
-        this->bounds.center.x - this->bounds.halfWidth/2,
-        this->bounds.center.y - this->bounds.halfHeight/2
-    };
-    vec2<double> neCenter = {
-        this->bounds.center.x + this->bounds.halfWidth/2,
-        this->bounds.center.y - this->bounds.halfHeight/2
-    };
-    vec2<double> swCenter = {
-        this->bounds.center.x - this->bounds.halfWidth/2,
-        this->bounds.center.y + this->bounds.halfHeight/2
-    };
-    vec2<double> seCenter = {
-        this->bounds.center.x + this->bounds.halfWidth/2,
-        this->bounds.center.y + this->bounds.halfHeight/2
-    };
+template<typename B>
+bool QuadTree<T>::fitsInside(int index, const B& box) const {
+    const AABB& bounds = this->nodes[index].bounds;
 
-    this->quads[0] = new QuadTree(
-        this->level + 1,
-        AABB(nwCenter, this->bounds.halfWidth/2, this->bounds.halfHeight/2)
-    );
-    this->quads[1] = new QuadTree(
-        this->level + 1,
-        AABB(neCenter, this->bounds.halfWidth/2, this->bounds.halfHeight/2)
-    );
-    this->quads[2] = new QuadTree(
-        this->level + 1,
-        AABB(swCenter, this->bounds.halfWidth/2, this->bounds.halfHeight/2)
-    );
-    this->quads[3] = new QuadTree(
-        this->level + 1,
-        AABB(seCenter, this->bounds.halfWidth/2, this->bounds.halfHeight/2)
-    );
+    return box.getTopY()    >= bounds.getTopY()
+        && box.getBottomY() <= bounds.getBottomY()
+        && box.getLeftX()   >= bounds.getLeftX()
+        && box.getRightX()  <= bounds.getRightX();
+}
+
+template<typename T>
+void QuadTree<T>::adjustCounts(int index, int delta) {
+    while (index != -1) {
+        this->nodes[index].count += delta;
+        index = this->nodes[index].parent;
+    }
+}
+
+template<typename T>
+int QuadTree<T>::detach(T* item) {
+    if (item->treeGeneration != this->generation) return -1;
+
+    int         index = item->treeNode;
+    vector<T*>& items = this->nodes[index].items;
+
+    // Item order within a node doesn't matter, so swap and pop
+    for (size_t i = 0; i < items.size(); i++) {
+        if (items[i] == item) {
+            items[i] = items.back();
+            items.pop_back();
+            this->adjustCounts(index, -1);
+
+            return index;
+        }
+    }
+
+    return -1;
+}
+
+template<typename T>
+void QuadTree<T>::prune(int index) {
+    int firstQuad = this->nodes[index].firstQuad;
+
+    if (firstQuad == -1) return;
+
+    if (static_cast<size_t>(this->nodes[index].count) == this->nodes[index].items.size()) {
+        // None of the items are in the quadrants, so they can be merged back
+        this->release(index);
+        return;
+    }
+
+    for (int i = 0; i < 4; i++) {
+        this->prune(firstQuad + i);
+    }
 }
 
 template<typename T>
-int QuadTree<T>::findFittingQuadrant(AABBCommon& box) const {
+void QuadTree<T>::release(int index) {
+    int firstQuad = this->nodes[index].firstQuad;
+
+    if (firstQuad == -1) return;
+
+    for (int i = 0; i < 4; i++) {
+        this->release(firstQuad + i);
+    }
+
+    this->freeQuads.push_back(firstQuad);
+    this->nodes[index].firstQuad = -1;
+}
+
+template<typename T>
+template<typename B>
+int QuadTree<T>::findFittingQuadrant(int index, const B& box) const {
+    const AABB& bounds = this->nodes[index].bounds;
+
     bool fitsNorth = false;
     bool fitsSouth = false;
     bool fitsWest = false;
@@ -88,21 +207,21 @@ int QuadTree<T>::findFittingQuadrant(AABBCommon& box) const {
 
     // Check if the given box fits any possible halves of this node's bounds
     // In theory, no more than 2 of these should be true at the same time
-    if (box.getBottomY() <= this->bounds.center.y) {
+    if (box.getBottomY() <= bounds.center.y) {
         fitsNorth = true;
     }
-    if (box.getTopY() >= this->bounds.center.y) {
+    if (box.getTopY() >= bounds.center.y) {
         fitsSouth = true;
     }
-    if (box.getRightX() <= this->bounds.center.x) {
+    if (box.getRightX() <= bounds.center.x) {
         fitsWest = true;
     }
-    if (box.getLeftX() >= this->bounds.center.x) {
+    if (box.getLeftX() >= bounds.center.x) {
         fitsEast = true;
     }
 
     // If the item fits a vertical and a horizontal half, that's a quadrant
-    // Return the this->quads index of the quadrant in question
+    // Return the QUAD_* index of the quadrant in question
     if (fitsNorth) {
         if (fitsWest) {
             return QUAD_NW;
@@ -126,49 +245,74 @@ int QuadTree<T>::findFittingQuadrant(AABBCommon& box) const {
 template<typename T>
 void QuadTree<T>::insert(T* item) {
     // Ignore this item if it's outside the bounds of the root node of the tree
-    if (this->level == 0
-    &&  item->getBounds().intersects(this->bounds) == INTERSECT_NONE) {
+    if (intersectBoxes(item->getBounds(), this->nodes[0].bounds) == INTERSECT_NONE) {
         return;
     }
 
+    this->insert(0, item);
+}
+
+template<typename T>
+void QuadTree<T>::place(int index, T* item) {
+    this->nodes[index].items.push_back(item);
+
+    item->treeNode = index;
+    item->treeGeneration = this->generation;
+}
+
+template<typename T>
+void QuadTree<T>::insert(int index, T* item) {
+    /*
+     * PS: inserting into a quadrant may subdivide it, which may grow the node
+     * pool and invalidate any references to its nodes, so nodes are always
+     * accessed through their index here
+     */
+
+    this->nodes[index].count++;
+
     // Does this node already have quadrants generated?
-    if (this->quads[0] != nullptr) {
-        int fitsIndex = this->findFittingQuadrant(item->getBounds());
+    if (this->nodes[index].firstQuad != -1) {
+        int fitsIndex = this->findFittingQuadrant(index, item->getBounds());
 
         // Insert this item into a quadrant instead, if there's one that fits it
         if (fitsIndex != -1) {
-            this->quads[fitsIndex]->insert(item);
+            this->insert(this->nodes[index].firstQuad + fitsIndex, item);
             return;
         }
     }
 
     // No quads generated or it doesn't fit into any of them, so insert it into
     // this node
-    this->items.push_back(item);
+    this->place(index, item);
 
     // Split this node if it's now above capacity
-    if (this->items.size() > QuadTree::BUCKET_CAPACITY
-    &&  this->level < QuadTree::MAX_LEVELS) {
-        if (this->quads[0] == nullptr) {
-            this->subdivide();
-        }
+    // Nodes that are already split only hold items which didn't fit into any
+    // of their quadrants, so their items don't need to be checked again
+    if (this->nodes[index].items.size() > QuadTree::BUCKET_CAPACITY
+    &&  this->nodes[index].level < QuadTree::MAX_LEVELS
+    &&  this->nodes[index].firstQuad == -1) {
+        this->subdivide(index);
 
         /*
          * Move this node's items into its newly-generated quadrants, if
          * they fit
          *
          * This looks like it should be a for loop. However, once an element is
-         * erased from this->items, the elements behind it get shifted forward
-         * by one index, so the index should not increment in such a scenario
+         * erased from the node's items, the elements behind it get shifted
+         * forward by one index, so the index should not increment in such a
+         * scenario
          */
-        int i = 0;
+        size_t i = 0;
 
-        while (i < this->items.size()) {
-            int fitsIndex = this->findFittingQuadrant(this->items[i]->getBounds());
+        while (i < this->nodes[index].items.size()) {
+            T*  movingItem = this->nodes[index].items[i];
+            int fitsIndex  = this->findFittingQuadrant(index, movingItem->getBounds());
 
             if (fitsIndex != -1) {
-                this->quads[fitsIndex]->insert(this->items[i]);
-                this->items.erase(this->items.begin() + i);
+                // The item stays within this node's count, so only the
+                // quadrant's count is increased
+                this->insert(this->nodes[index].firstQuad + fitsIndex, movingItem);
+                this->nodes[index].items.erase(this->nodes[index].items.begin() + i);
                 continue;
             }
 
@@ -178,34 +322,223 @@ void QuadTree<T>::insert(T* item) {
 }
 
 template<typename T>
-vector<T*> QuadTree<T>::findPossibleCollisions(
-    AABBCommon& box,
-    vector<T*> acc
+void QuadTree<T>::build(int index, int begin, int end) {
+    this->nodes[index].count = end - begin;
+
+    // As with insert(), nodes are only split once they hold too many items
+    if (end - begin <= QuadTree::BUCKET_CAPACITY
+    ||  this->nodes[index].level >= QuadTree::MAX_LEVELS) {
+        for (int i = begin; i < end; i++) {
+            this->nodes[index].items.push_back(this->buildItems[i].item);
+            this->buildNodes[this->buildItems[i].order] = index;
+        }
+
+        return;
+    }
+
+    this->subdivide(index);
+
+    // Group the items by the quadrant they fit into, keeping their order, with
+    // the ones that don't fit into any first (i.e. quadrant -1 + 1)
+    int counts[5] = {0};
+
+    for (int i = begin; i < end; i++) {
+        int group = this->findFittingQuadrant(index, this->buildItems[i]) + 1;
+
+        this->buildQuads[i] = group;
+        counts[group]++;
+    }
+
+    int starts[5];
+    int next[5];
+
+    starts[0] = begin;
+
+    for (int group = 1; group < 5; group++) {
+        starts[group] = starts[group - 1] + counts[group - 1];
+    }
+
+    std::copy(starts, starts + 5, next);
+
+    for (int i = begin; i < end; i++) {
+        this->buildSorted[next[this->buildQuads[i]]++] = this->buildItems[i];
+    }
+
+    std::copy(
+        this->buildSorted.begin() + begin,
+        this->buildSorted.begin() + end,
+        this->buildItems.begin() + begin
+    );
+
+    for (int i = starts[0]; i < starts[1]; i++) {
+        this->nodes[index].items.push_back(this->buildItems[i].item);
+        this->buildNodes[this->buildItems[i].order] = index;
+    }
+
+    // PS: building a quadrant may subdivide it, which may grow the node pool
+    // and invalidate any references to its nodes
+    int firstQuad = this->nodes[index].firstQuad;
+
+    for (int i = 0; i < 4; i++) {
+        this->build(firstQuad + i, starts[i + 1], starts[i + 1] + counts[i + 1]);
+    }
+}
+
+template<typename T>
+void QuadTree<T>::rebuild(const vector<T*>& items) {
+    this->clear();
+
+    // Ignore items outside the bounds of the root node, as insert() does
+    this->buildItems.clear();
+    this->buildNodes.assign(items.size(), -1);
+
+    for (size_t i = 0; i < items.size(); i++) {
+        AABB bounds = items[i]->getBounds();
+
+        if (intersectBoxes(bounds, this->nodes[0].bounds) != INTERSECT_NONE) {
+            this->buildItems.push_back({
+                items[i],
+                static_cast<int>(i),
+                bounds.getTopY(),
+                bounds.getBottomY(),
+                bounds.getLeftX(),
+                bounds.getRightX()
+            });
+        }
+    }
+
+    this->buildSorted.resize(this->buildItems.size());
+    this->buildQuads.resize(this->buildItems.size());
+
+    this->build(0, 0, this->buildItems.size());
+
+    // Locations are only written to the items once they're all placed, in the
+    // order the items were given in, as build() visits them in a scattered
+    // order which would miss the cache on every item
+    for (size_t i = 0; i < items.size(); i++) {
+        if (this->buildNodes[i] != -1) {
+            items[i]->treeNode = this->buildNodes[i];
+            items[i]->treeGeneration = this->generation;
+        }
+    }
+}
+
+template<typename T>
+void QuadTree<T>::update(T* item) {
+    if (item->treeGeneration != this->generation) {
+        this->insert(item);
+        return;
+    }
+
+    int index = item->treeNode;
+
+    // Nothing to do if the item is still within its node
+    // Items in the root node only need to stay within the tree's bounds
+    if (index == 0) {
+        if (intersectBoxes(item->getBounds(), this->nodes[0].bounds) != INTERSECT_NONE) {
+            return;
+        }
+    } else if (this->fitsInside(index, item->getBounds())) {
+        return;
+    }
+
+    this->detach(item);
+
+    if (metricsEnabled) quadTreeRelocations.add();
+
+    // Reinsert the item from the closest node that can still hold it
+    int target = this->nodes[index].parent;
+
+    while (target > 0 && !this->fitsInside(target, item->getBounds())) {
+        target = this->nodes[target].parent;
+    }
+
+    if (target > 0) {
+        this->adjustCounts(this->nodes[target].parent, 1);
+        this->insert(target, item);
+    } else if (intersectBoxes(item->getBounds(), this->nodes[0].bounds) != INTERSECT_NONE) {
+        this->insert(0, item);
+    } else {
+        // The item has left the tree's bounds altogether
+        item->treeGeneration = -1;
+    }
+}
+
+template<typename T>
+bool QuadTree<T>::remove(T* item) {
+    if (this->detach(item) == -1) return false;
+
+    item->treeGeneration = -1;
+
+    return true;
+}
+
+template<typename T>
+void QuadTree<T>::prune() {
+    this->prune(0);
+}
+
+template<typename T>
+template<typename B, typename F>
+bool QuadTree<T>::forEachPossibleCollision(const B& box, F visit) const {
+    if (metricsEnabled) quadTreeQueries.add();
+
+    return this->forEachPossibleCollision(0, box, visit);
+}
+
+template<typename T>
+template<typename B, typename F>
+bool QuadTree<T>::forEachPossibleCollision(
+    int index,
+    const B& box,
+    F& visit
 ) const {
-    // acc is an accumulator with all items that could collide with this box
+    const Node& node = this->nodes[index];
 
     // Recursively consider items from this node's quadrants, if it has any
-    if (this->quads[0] != nullptr) {
-        int index = this->findFittingQuadrant(box);
+    if (node.firstQuad != -1) {
+        int fitsIndex = this->findFittingQuadrant(index, box);
 
-        if (index != -1) {
+        if (fitsIndex != -1) {
             // If this box fully fits into a quadrant, consider collisions with
             // only items that are within that quadrant
-            acc = this->quads[index]->findPossibleCollisions(box, acc);
+            if (!this->forEachPossibleCollision(node.firstQuad + fitsIndex, box, visit)) {
+                return false;
+            }
         } else {
             // If not, consider collisions with items in all of this node's
             // quadrants
-            acc = this->quads[0]->findPossibleCollisions(box, acc);
-            acc = this->quads[1]->findPossibleCollisions(box, acc);
-            acc = this->quads[2]->findPossibleCollisions(box, acc);
-            acc = this->quads[3]->findPossibleCollisions(box, acc);
+            for (int i = 0; i < 4; i++) {
+                if (!this->forEachPossibleCollision(node.firstQuad + i, box, visit)) {
+                    return false;
+                }
+            }
         }
     }
 
     // Consider all items from this node
-    for (T* item : this->items) {
-        acc.push_back(item);
+    if (metricsEnabled) quadTreeCandidates.add(node.items.size());
+
+    for (T* item : node.items) {
+        if (!visit(item)) return false;
     }
 
+    return true;
+}
+
+template<typename T>
+void QuadTree<T>::findPossibleCollisions(AABBCommon& box, vector<T*>& acc) const {
+    this->forEachPossibleCollision(box, [&acc](T* item) {
+        acc.push_back(item);
+        return true;
+    });
+}
+
+template<typename T>
+vector<T*> QuadTree<T>::findPossibleCollisions(AABBCommon& box) const {
+    vector<T*> acc;
+
+    this->findPossibleCollisions(box, acc);
+
     return acc;
-}
\ No newline at end of file
+}
@@ -0,0 +1,106 @@
+#include "runner.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "world.hpp"
+
+using std::vector;
+
+/* -- WorldRunner -- */
+
+// Constructors
+WorldRunner::WorldRunner(int threadCount) {
+    if (threadCount <= 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (int i = 0; i < threadCount; i++) {
+        this->threads.emplace_back(&WorldRunner::work, this);
+    }
+}
+
+// Destructors
+WorldRunner::~WorldRunner() {
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->stopping = true;
+    }
+
+    this->batchStarted.notify_all();
+
+    for (std::thread& thread : this->threads) {
+        thread.join();
+    }
+}
+
+// Getters
+int WorldRunner::getThreadCount() const { return this->threads.size(); }
+
+// Other methods
+double WorldRunner::run(const vector<World*>& worlds, int ticks) {
+    auto start = std::chrono::steady_clock::now();
+
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+
+        this->worlds      = worlds.data();
+        this->worldCount  = worlds.size();
+        this->ticks       = ticks;
+        this->busyThreads = this->threads.size();
+        this->nextWorld.store(0);
+        this->batch++;
+    }
+
+    this->batchStarted.notify_all();
+
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->batchFinished.wait(lock, [this]() { return this->busyThreads == 0; });
+
+    return std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start
+    ).count();
+}
+
+void WorldRunner::work() {
+    uint64_t lastBatch = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->batchStarted.wait(lock, [&]() {
+                return this->stopping || this->batch != lastBatch;
+            });
+
+            if (this->stopping) return;
+
+            lastBatch = this->batch;
+        }
+
+        // Take worlds until there are none left in the batch
+        int index;
+
+        while ((index = this->nextWorld.fetch_add(1)) < this->worldCount) {
+            World* world = this->worlds[index];
+
+            for (int i = 0; i < this->ticks; i++) {
+                world->step();
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->busyThreads--;
+
+            if (this->busyThreads == 0) {
+                this->batchFinished.notify_one();
+            }
+        }
+    }
+}
@@ -0,0 +1,63 @@
+// Stepping many worlds at once on a pool of threads
+
+#ifndef RUNNER_HPP
+#define RUNNER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "world.hpp"
+
+using std::vector;
+
+/*
+ * Steps batches of independent worlds on a fixed set of worker threads
+ *
+ * The threads are started once and wait between batches. Within a batch,
+ * worlds are handed out one at a time through an atomic counter, and each one
+ * is stepped for all of the batch's ticks before the next is taken, so threads
+ * which get cheaper worlds simply take more of them.
+ *
+ * A world is only ever stepped by one thread at a time, so no locking happens
+ * while stepping. See World for what state is shared between worlds.
+ */
+class WorldRunner {
+    private:
+        vector<std::thread>     threads;
+        std::mutex              mutex;
+        std::condition_variable batchStarted;
+        std::condition_variable batchFinished;
+
+        // The current batch
+        World* const*    worlds      = nullptr;
+        int              worldCount  = 0;
+        int              ticks       = 0;
+        std::atomic<int> nextWorld{0};  // Index of the next world to take
+        int              busyThreads = 0;
+        uint64_t         batch       = 0; // Incremented by every run() call
+        bool             stopping    = false;
+
+        // Loop run by each worker thread
+        void work();
+    public:
+        // Starts the given number of threads, or one per core if it's 0
+        WorldRunner(int threadCount = 0);
+        WorldRunner(const WorldRunner&) = delete;
+        WorldRunner& operator=(const WorldRunner&) = delete;
+
+        // Stops the threads, once they are done waiting for a batch
+        ~WorldRunner();
+
+        int getThreadCount() const;
+
+        // Step each of the given worlds by the given number of ticks, returning
+        // once all of them are done
+        // Returns how long it took, in seconds
+        double run(const vector<World*>& worlds, int ticks);
+};
+
+#endif
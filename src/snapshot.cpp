@@ -0,0 +1,345 @@
+#include "snapshot.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "input.hpp"
+#include "levelfile.hpp"
+#include "levels.hpp"
+#include "objects.hpp"
+#include "physics.hpp"
+#include "tilestream.hpp"
+#include "profiler.hpp"
+#include "world.hpp"
+
+using std::string;
+using std::vector;
+
+// Comes first in every snapshot, followed by each section at the offset
+// given by SnapshotLayout
+struct SnapshotHeader {
+    char      magic[4];
+    uint32_t  version;
+    uint64_t  size;            // Of the whole snapshot, in bytes
+    int64_t   ticks;           // World::ticks
+    uint32_t  objectCount;     // Also the number of physics slots
+    uint32_t  levelNameLength;
+    double    streamCenterX;   // World::streamCenter
+    double    streamCenterY;
+    TickInput lastInput;       // World::lastPlayerInput
+};
+
+// The arrays of doubles in PhysicsWorld, in the order they're saved in
+static const int SNAPSHOT_ARRAY_COUNT = 9;
+
+static vector<double> PhysicsWorld::* const SNAPSHOT_ARRAYS[SNAPSHOT_ARRAY_COUNT] = {
+    &PhysicsWorld::centerX,
+    &PhysicsWorld::centerY,
+    &PhysicsWorld::lastCenterX,
+    &PhysicsWorld::lastCenterY,
+    &PhysicsWorld::halfWidth,
+    &PhysicsWorld::halfHeight,
+    &PhysicsWorld::speedX,
+    &PhysicsWorld::speedY,
+    &PhysicsWorld::weight
+};
+
+// Byte offsets of each section of a snapshot with the given number of objects
+// Sections of doubles come first, then ObjectStates, then smaller values, so
+// that every section is aligned
+struct SnapshotLayout {
+    size_t physics;   // Arrays of doubles, in SNAPSHOT_ARRAYS order
+    size_t states;    // ObjectState per slot
+    size_t health;    // int32_t per slot
+    size_t order;     // int32_t per object in gameObjects, its slot
+    size_t grounded;  // uint8_t per slot
+    size_t levelName;
+    size_t strings;   // Per slot, the length of its state string then its
+                      // characters, as many as are left until the end
+
+    SnapshotLayout(size_t objectCount, size_t levelNameLength) {
+        this->physics   = (sizeof(SnapshotHeader) + 7) & ~size_t(7);
+        this->states    = this->physics + SNAPSHOT_ARRAY_COUNT*objectCount*sizeof(double);
+        this->health    = this->states + objectCount*sizeof(ObjectState);
+        this->order     = this->health + objectCount*sizeof(int32_t);
+        this->grounded  = this->order + objectCount*sizeof(int32_t);
+        this->levelName = this->grounded + objectCount;
+        this->strings   = this->levelName + levelNameLength;
+    }
+};
+
+// Which slots have been found in a snapshot's gameObjects order so far, reused
+// by every restoreSnapshot() call on the same thread
+static thread_local vector<bool> orderedSlots;
+
+// Objects of each type for restoreSnapshot() to hand out to slots, and the
+// object each slot gets, reused by every call on the same thread
+static thread_local vector<GameObject*> restoredPlayers;
+static thread_local vector<GameObject*> restoredProjectiles;
+static thread_local vector<GameObject*> slotOwners;
+
+// State strings are saved with a single byte for their length
+static const size_t MAX_STATE_LENGTH = 255;
+
+void saveSnapshot(const World& world, vector<uint8_t>& buffer) {
+    ScopedTimer timer("snapshot_save");
+
+    size_t objectCount = world.physics.size();
+
+    SnapshotLayout layout(objectCount, world.levelName.size());
+
+    // Every state string takes at least its length byte, longer ones grow the
+    // buffer as they're added
+    buffer.resize(layout.strings + objectCount);
+
+    for (int i = 0; i < SNAPSHOT_ARRAY_COUNT; i++) {
+        memcpy(
+            &buffer[layout.physics + i*objectCount*sizeof(double)],
+            (world.physics.*SNAPSHOT_ARRAYS[i]).data(),
+            objectCount*sizeof(double)
+        );
+    }
+
+    memcpy(&buffer[layout.health], world.physics.health.data(), objectCount*sizeof(int32_t));
+    memcpy(&buffer[layout.grounded], world.physics.grounded.data(), objectCount);
+    memcpy(&buffer[layout.levelName], world.levelName.data(), world.levelName.size());
+
+    for (size_t i = 0; i < world.gameObjects.size(); i++) {
+        int32_t slot = world.gameObjects[i]->getSlot();
+        memcpy(&buffer[layout.order + i*sizeof(int32_t)], &slot, sizeof(int32_t));
+    }
+
+    // Written in place, layout.states is aligned to 8 bytes within the buffer
+    ObjectState* states = reinterpret_cast<ObjectState*>(&buffer[layout.states]);
+
+    for (size_t slot = 0; slot < objectCount; slot++) {
+        GameObject* gobj = world.physics.owners[slot];
+
+        // Cleared first, as saveState() doesn't write the padding, and the
+        // buffer may still hold an older snapshot's bytes there
+        states[slot] = ObjectState();
+        gobj->saveState(states[slot]);
+        states[slot].type = static_cast<uint8_t>(gobj->getObjectType());
+    }
+
+    size_t stringsEnd = layout.strings;
+
+    for (size_t slot = 0; slot < objectCount; slot++) {
+        const string& name   = world.physics.owners[slot]->getState();
+        size_t        length = std::min(name.size(), MAX_STATE_LENGTH);
+
+        if (length > 0) {
+            buffer.resize(buffer.size() + length);
+        }
+
+        buffer[stringsEnd] = length;
+        memcpy(&buffer[stringsEnd + 1], name.data(), length);
+        stringsEnd += 1 + length;
+    }
+
+    // Zeroed, padding included, so that identical states always make
+    // identical snapshots
+    // lastInput is copied field by field, as copying it whole could also copy
+    // its padding
+    SnapshotHeader header{};
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version           = SNAPSHOT_VERSION;
+    header.size              = buffer.size();
+    header.ticks             = world.ticks;
+    header.objectCount       = objectCount;
+    header.levelNameLength   = world.levelName.size();
+    header.streamCenterX     = world.streamCenter.x;
+    header.streamCenterY     = world.streamCenter.y;
+    header.lastInput.buttons = world.lastPlayerInput.buttons;
+    header.lastInput.aimX    = world.lastPlayerInput.aimX;
+    header.lastInput.aimY    = world.lastPlayerInput.aimY;
+
+    memcpy(buffer.data(), &header, sizeof(SnapshotHeader));
+}
+
+bool restoreSnapshot(World& world, const uint8_t* data, size_t size) {
+    ScopedTimer timer("snapshot_restore");
+
+    /* -- Validation -- */
+
+    SnapshotHeader header;
+
+    if (size < sizeof(SnapshotHeader)) return false;
+
+    memcpy(&header, data, sizeof(SnapshotHeader));
+
+    if (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0
+    ||  header.version != SNAPSHOT_VERSION
+    ||  header.size != size
+    ||  !std::isfinite(header.streamCenterX)
+    ||  !std::isfinite(header.streamCenterY)) {
+        return false;
+    }
+
+    size_t objectCount = header.objectCount;
+
+    SnapshotLayout layout(objectCount, header.levelNameLength);
+
+    if (layout.strings > size) return false;
+
+    // Objects of any other type can't be created again, objects can only
+    // refer to slots that exist, and each slot must be in gameObjects once
+    size_t stringsEnd  = layout.strings;
+    size_t playerCount = 0;
+
+    orderedSlots.assign(objectCount, false);
+
+    for (size_t slot = 0; slot < objectCount; slot++) {
+        ObjectState state;
+        int32_t     orderSlot;
+
+        memcpy(&state, &data[layout.states + slot*sizeof(ObjectState)], sizeof(ObjectState));
+        memcpy(&orderSlot, &data[layout.order + slot*sizeof(int32_t)], sizeof(int32_t));
+
+        if ((state.type != static_cast<uint8_t>(eObjTypes::player)
+        &&   state.type != static_cast<uint8_t>(eObjTypes::projectile))
+        ||  state.owner < -1 || state.owner >= static_cast<int64_t>(objectCount)
+        ||  orderSlot < 0 || orderSlot >= static_cast<int64_t>(objectCount)
+        ||  orderedSlots[orderSlot]) {
+            return false;
+        }
+
+        orderedSlots[orderSlot] = true;
+
+        if (state.type == static_cast<uint8_t>(eObjTypes::player)) {
+            playerCount++;
+        }
+
+        if (stringsEnd >= size) return false;
+
+        stringsEnd += 1 + data[stringsEnd];
+    }
+
+    if (stringsEnd != size) return false;
+
+    string levelName(
+        reinterpret_cast<const char*>(&data[layout.levelName]),
+        header.levelNameLength
+    );
+
+    // The name is used as part of a path, so it mustn't be able to point
+    // outside of the levels directory
+    if (!isValidLevelName(levelName)) return false;
+
+    // A streamed level starts out with the chunks around streamCenter, so it
+    // must be moved before the level is loaded
+    vec2<double> lastStreamCenter = world.streamCenter;
+
+    world.streamCenter = {header.streamCenterX, header.streamCenterY};
+
+    if (world.level == nullptr || levelName != world.levelName) {
+        if (world.loadLevel(levelName) == nullptr) {
+            world.streamCenter = lastStreamCenter;
+            return false;
+        }
+    }
+
+    // Otherwise the stream would still hold the chunks around where the
+    // world was before restoring, until the next step
+    if (world.tilesStream != nullptr) {
+        world.tilesStream->update(world.streamCenter.x, world.streamCenter.y);
+    }
+
+    /* -- Objects -- */
+
+    // Live objects are kept for slots of the same type, so that only the
+    // difference in the number of objects of each type is destroyed or
+    // created
+    size_t projectileCount = objectCount - playerCount;
+
+    restoredPlayers.clear();
+    restoredProjectiles.clear();
+
+    for (GameObject* gobj : world.gameObjects) {
+        eObjTypes type = gobj->getObjectType();
+
+        if (type == eObjTypes::player && restoredPlayers.size() < playerCount) {
+            restoredPlayers.push_back(gobj);
+        } else if (type == eObjTypes::projectile && restoredProjectiles.size() < projectileCount) {
+            restoredProjectiles.push_back(gobj);
+        } else {
+            world.destroyGameObject(gobj);
+        }
+    }
+
+    while (restoredPlayers.size() < playerCount) {
+        restoredPlayers.push_back(world.playerPool.create(world.physics, 0, 0));
+    }
+
+    while (restoredProjectiles.size() < projectileCount) {
+        restoredProjectiles.push_back(
+            world.projectilePool.create(world.physics, world.playerPool, nullptr, -1, 0, 0)
+        );
+    }
+
+    // Hand the objects out in order to the slots of their type, every slot's
+    // values are overwritten below
+    size_t nextPlayer     = 0;
+    size_t nextProjectile = 0;
+
+    slotOwners.resize(objectCount);
+
+    for (size_t slot = 0; slot < objectCount; slot++) {
+        uint8_t type = data[layout.states + slot*sizeof(ObjectState) + offsetof(ObjectState, type)];
+
+        if (type == static_cast<uint8_t>(eObjTypes::player)) {
+            slotOwners[slot] = restoredPlayers[nextPlayer++];
+        } else {
+            slotOwners[slot] = restoredProjectiles[nextProjectile++];
+        }
+    }
+
+    world.physics.reassign(slotOwners);
+
+    for (int i = 0; i < SNAPSHOT_ARRAY_COUNT; i++) {
+        memcpy(
+            (world.physics.*SNAPSHOT_ARRAYS[i]).data(),
+            &data[layout.physics + i*objectCount*sizeof(double)],
+            objectCount*sizeof(double)
+        );
+    }
+
+    memcpy(world.physics.health.data(), &data[layout.health], objectCount*sizeof(int32_t));
+    memcpy(world.physics.grounded.data(), &data[layout.grounded], objectCount);
+
+    size_t stringsPos = layout.strings;
+
+    for (size_t slot = 0; slot < objectCount; slot++) {
+        GameObject* gobj = world.physics.owners[slot];
+
+        ObjectState state;
+        memcpy(&state, &data[layout.states + slot*sizeof(ObjectState)], sizeof(ObjectState));
+        gobj->loadState(state);
+
+        size_t length = data[stringsPos];
+        gobj->setState(string(reinterpret_cast<const char*>(&data[stringsPos + 1]), length));
+        stringsPos += 1 + length;
+    }
+
+    world.gameObjects.clear();
+
+    for (size_t i = 0; i < objectCount; i++) {
+        int32_t slot;
+        memcpy(&slot, &data[layout.order + i*sizeof(int32_t)], sizeof(int32_t));
+
+        world.gameObjects.push_back(world.physics.owners[slot]);
+    }
+
+    // Built in one go once every object is in place
+    world.gameObjectsTree->rebuild(world.gameObjects);
+
+    world.ticks = header.ticks;
+    world.lastPlayerInput = header.lastInput;
+
+    return true;
+}
@@ -0,0 +1,50 @@
+// Saving a whole World into a flat buffer, and restoring it from one
+
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "world.hpp"
+
+using std::vector;
+
+// Identifies snapshots, along with SNAPSHOT_VERSION
+const char     SNAPSHOT_MAGIC[4] = {'P', 'G', 'S', 'N'};
+const uint32_t SNAPSHOT_VERSION  = 2;
+
+/*
+ * Write the state of a world into buffer, replacing its contents
+ *
+ * This covers every object in gameObjects, the name of the loaded level,
+ * streamCenter, ticks and lastPlayerInput. Objects are stored in physics's slot order: each
+ * slot's arrays are copied as is, followed by the rest of each object's state
+ * as an ObjectState, with references to other objects stored as slots rather
+ * than pointers.
+ *
+ * The snapshot contains no pointers, so it can be copied or written to a file
+ * freely, but only restored on a machine with the same byte order.
+ *
+ * The buffer's capacity is reused, so saving into the same buffer again only
+ * allocates if the world has grown since.
+ *
+ * PS: every object with a slot in physics must be in gameObjects, which is
+ * always the case between calls to World::step()
+ */
+extern void saveSnapshot(const World& world, vector<uint8_t>& buffer);
+
+// Restore a world to the state saved in a snapshot
+// Live objects are reused for slots of the same type, and only the others are
+// destroyed or created from their pools, but any object may end up in another
+// slot, so pointers to objects (e.g. player) must be looked up again in
+// gameObjects
+// A streamed level's chunks are moved to the restored streamCenter before
+// returning
+// Returns false if the snapshot isn't valid, its level name isn't valid (see
+// isValidLevelName), or its level doesn't exist, in which case the world is
+// left untouched
+extern bool restoreSnapshot(World& world, const uint8_t* data, size_t size);
+
+#endif
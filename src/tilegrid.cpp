@@ -0,0 +1,97 @@
+#include "tilegrid.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <vector>
+
+#include "tiles.hpp"
+
+using std::max, std::min;
+using std::vector;
+
+/* -- TileGrid -- */
+
+// Constructors
+TileGrid::TileGrid(vector<Tile>& tiles) {
+    if (tiles.empty()) {
+        this->cellStarts = {0};
+        return;
+    }
+
+    // Find the area covered by all tiles, in grid coordinates
+    int minX = INT_MAX;
+    int minY = INT_MAX;
+    int maxX = INT_MIN;
+    int maxY = INT_MIN;
+
+    for (Tile& tile : tiles) {
+        TileAABB& bounds = tile.getBounds();
+
+        minX = min(minX, bounds.gridX);
+        minY = min(minY, bounds.gridY);
+        maxX = max(maxX, bounds.gridX + bounds.gridWidth);
+        maxY = max(maxY, bounds.gridY + bounds.gridHeight);
+    }
+
+    this->originX = minX;
+    this->originY = minY;
+    this->width   = maxX - minX;
+    this->height  = maxY - minY;
+
+    /*
+     * Fill the cells in two passes: first count how many tiles occupy each
+     * cell to find where each cell's list starts, then write the tiles into
+     * their cells' lists
+     */
+    this->cellStarts.assign(this->width*this->height + 1, 0);
+
+    for (int pass = 0; pass < 2; pass++) {
+        // Where the next tile of each cell should be written, second pass only
+        vector<int> cellEnds;
+
+        if (pass == 1) {
+            for (size_t cell = 1; cell < this->cellStarts.size(); cell++) {
+                this->cellStarts[cell] += this->cellStarts[cell - 1];
+            }
+
+            cellEnds.assign(this->cellStarts.begin(), this->cellStarts.end() - 1);
+            this->cellTiles.resize(this->cellStarts.back());
+        }
+
+        for (Tile& tile : tiles) {
+            TileAABB& bounds = tile.getBounds();
+
+            int firstX = bounds.gridX - this->originX;
+            int firstY = bounds.gridY - this->originY;
+            int lastX  = firstX + bounds.gridWidth;
+            int lastY  = firstY + bounds.gridHeight;
+
+            for (int y = firstY; y < lastY; y++) {
+                for (int x = firstX; x < lastX; x++) {
+                    int cell = y*this->width + x;
+
+                    if (pass == 0) {
+                        // Counts are offset by one, so that the running sum
+                        // gives each cell's start rather than its end
+                        this->cellStarts[cell + 1]++;
+                    } else {
+                        this->cellTiles[cellEnds[cell]++] = &tile;
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Getters
+int TileGrid::getWidth() const  { return this->width; }
+int TileGrid::getHeight() const { return this->height; }
+
+// Other methods
+void TileGrid::findPossibleCollisions(AABBCommon& box, vector<Tile*>& acc) const {
+    this->forEachPossibleCollision(box, [&acc](Tile* tile) {
+        acc.push_back(tile);
+        return true;
+    });
+}
@@ -0,0 +1,57 @@
+// A dense grid for looking up level tiles by the grid cells they occupy
+
+#ifndef TILEGRID_HPP
+#define TILEGRID_HPP
+
+#include <vector>
+
+#include "tiles.hpp"
+#include "util.hpp"
+
+using std::vector;
+
+/*
+ * Read-only lookup table from grid cells to the tiles occupying them, built
+ * once per level
+ *
+ * Since every tile is aligned to TILEGRID_CELL_SIZE, the tiles which could
+ * intersect a box can be read straight from the cells the box overlaps, at a
+ * constant cost per cell. Tiles whose TileType spans multiple cells are listed
+ * in every cell they occupy.
+ *
+ * The cells' contents are stored in a compressed form: cellStarts holds, for
+ * each cell, where its list of tiles begins within cellTiles. This also allows
+ * several tiles to share a cell.
+ *
+ * The tiles must not be moved or destroyed while the grid is in use.
+ */
+class TileGrid {
+    private:
+        int           originX = 0; // Grid coordinates of the first cell
+        int           originY = 0;
+        int           width   = 0; // Size of the grid, in cells
+        int           height  = 0;
+        vector<int>   cellStarts;  // Indices into cellTiles, one per cell + 1
+        vector<Tile*> cellTiles;   // The tiles in each cell, in cell order
+    public:
+        TileGrid(vector<Tile>& tiles);
+
+        int getWidth() const;
+        int getHeight() const;
+
+        // Look for tiles which occupy any of the cells overlapped by the given
+        // box, calling visit(Tile* tile) once for each of them
+        // The search stops as soon as visit returns false, in which case this
+        // also returns false
+        template <typename B, typename F>
+        bool forEachPossibleCollision(const B& box, F visit) const;
+
+        // Look for tiles which occupy any of the cells overlapped by the given
+        // box
+        // Matched tiles are appended to acc, which is not cleared beforehand
+        void findPossibleCollisions(AABBCommon& box, vector<Tile*>& acc) const;
+};
+
+#include "tilegrid.tpp"
+
+#endif
@@ -0,0 +1,51 @@
+#include "tilegrid.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "tiles.hpp"
+#include "util.hpp"
+
+using std::max, std::min;
+
+/* -- TileGrid -- */
+
+template <typename B, typename F>
+bool TileGrid::forEachPossibleCollision(const B& box, F visit) const {
+    // Range of cells overlapped by the box, in grid coordinates
+    // Cells which the box is only touching are left out
+    int firstX = std::floor(box.getLeftX()/TILEGRID_CELL_SIZE);
+    int firstY = std::floor(box.getTopY()/TILEGRID_CELL_SIZE);
+    int lastX  = std::ceil(box.getRightX()/TILEGRID_CELL_SIZE) - 1;
+    int lastY  = std::ceil(box.getBottomY()/TILEGRID_CELL_SIZE) - 1;
+
+    // Only consider cells within the grid
+    firstX = max(firstX, this->originX);
+    firstY = max(firstY, this->originY);
+    lastX  = min(lastX, this->originX + this->width - 1);
+    lastY  = min(lastY, this->originY + this->height - 1);
+
+    for (int y = firstY; y <= lastY; y++) {
+        int row = (y - this->originY)*this->width - this->originX;
+
+        for (int x = firstX; x <= lastX; x++) {
+            int cell = row + x;
+
+            for (int i = this->cellStarts[cell]; i < this->cellStarts[cell + 1]; i++) {
+                Tile*     tile   = this->cellTiles[i];
+                TileAABB& bounds = tile->getBounds();
+
+                // A tile spanning multiple cells is only visited from the
+                // first of its cells within the range, to avoid duplicates
+                if (x != max(bounds.gridX, firstX)
+                ||  y != max(bounds.gridY, firstY)) {
+                    continue;
+                }
+
+                if (!visit(tile)) return false;
+            }
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,162 @@
+#include "tileindex.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <vector>
+
+#include "tiles.hpp"
+
+using std::max, std::min;
+using std::sort;
+using std::vector;
+
+// Spread the lower 16 bits of a number out to the even bits of the result
+// e.g. 0b1011 becomes 0b01000101
+static uint32_t spreadBits(uint32_t x) {
+    x &= 0x0000FFFF;
+    x = (x | (x << 8)) & 0x00FF00FF;
+    x = (x | (x << 4)) & 0x0F0F0F0F;
+    x = (x | (x << 2)) & 0x33333333;
+    x = (x | (x << 1)) & 0x55555555;
+
+    return x;
+}
+
+/* -- StaticTileIndex -- */
+
+// Constructors
+StaticTileIndex::StaticTileIndex(vector<Tile>& tiles) {
+    int tileCount = tiles.size();
+
+    if (tileCount == 0) return;
+
+    /* -- Sort tiles along the Z-order curve -- */
+
+    // The area covered by all tiles, used for scaling their positions to the
+    // range of the Morton codes
+    int minX = INT_MAX;
+    int minY = INT_MAX;
+    int maxX = INT_MIN;
+    int maxY = INT_MIN;
+
+    for (Tile& tile : tiles) {
+        minX = min(minX, tile.getX());
+        minY = min(minY, tile.getY());
+        maxX = max(maxX, tile.getX() + tile.getWidth());
+        maxY = max(maxY, tile.getY() + tile.getHeight());
+    }
+
+    int64_t areaWidth  = max(maxX - minX, 1);
+    int64_t areaHeight = max(maxY - minY, 1);
+
+    // Pairs of Morton codes and indices into tiles
+    vector<std::pair<uint32_t, int>> order(tileCount);
+
+    for (int i = 0; i < tileCount; i++) {
+        // Twice the tile's center, to avoid rounding it
+        int64_t centerX = 2*tiles[i].getX() + tiles[i].getWidth() - 2*minX;
+        int64_t centerY = 2*tiles[i].getY() + tiles[i].getHeight() - 2*minY;
+
+        uint32_t mortonX = centerX*0xFFFF / (2*areaWidth);
+        uint32_t mortonY = centerY*0xFFFF / (2*areaHeight);
+
+        order[i] = {spreadBits(mortonX) | (spreadBits(mortonY) << 1), i};
+    }
+
+    sort(order.begin(), order.end());
+
+    /* -- Store the leaves, then build the parent nodes bottom up -- */
+
+    this->tiles.reserve(tileCount);
+    this->boxes.reserve(tileCount + tileCount/(StaticTileIndex::NODE_SIZE - 1) + 1);
+
+    for (auto& entry : order) {
+        Tile& tile = tiles[entry.second];
+
+        this->tiles.push_back(&tile);
+        this->boxes.push_back({
+            tile.getX(),
+            tile.getY(),
+            tile.getX() + tile.getWidth(),
+            tile.getY() + tile.getHeight()
+        });
+    }
+
+    this->levelEnds.push_back(tileCount);
+
+    int levelStart = 0;
+
+    // Keep grouping the previous level's boxes until there's a single root
+    while (this->levelEnds.back() - levelStart > 1) {
+        int levelEnd = this->levelEnds.back();
+
+        for (int i = levelStart; i < levelEnd; i += StaticTileIndex::NODE_SIZE) {
+            Box parent = this->boxes[i];
+
+            for (int j = i + 1; j < min(i + StaticTileIndex::NODE_SIZE, levelEnd); j++) {
+                const Box& child = this->boxes[j];
+
+                parent.leftX   = min(parent.leftX,   child.leftX);
+                parent.topY    = min(parent.topY,    child.topY);
+                parent.rightX  = max(parent.rightX,  child.rightX);
+                parent.bottomY = max(parent.bottomY, child.bottomY);
+            }
+
+            this->boxes.push_back(parent);
+        }
+
+        levelStart = levelEnd;
+        this->levelEnds.push_back(this->boxes.size());
+    }
+
+    this->boxData = this->boxes.data();
+    this->boxCount = this->boxes.size();
+}
+StaticTileIndex::StaticTileIndex(
+    vector<Tile>&   tiles,
+    const Box*      boxes,
+    int             boxCount,
+    const uint32_t* order,
+    const int32_t*  levelEnds,
+    int             levelCount
+) : levelEnds(levelEnds, levelEnds + levelCount),
+    boxData(boxes),
+    boxCount(boxCount) {
+    int leafCount = (levelCount > 0) ? levelEnds[0] : 0;
+
+    this->tiles.reserve(leafCount);
+
+    for (int i = 0; i < leafCount; i++) {
+        this->tiles.push_back(&tiles[order[i]]);
+    }
+}
+
+// Getters
+int                         StaticTileIndex::getTileCount() const        { return this->tiles.size(); }
+const StaticTileIndex::Box* StaticTileIndex::getBoxes() const            { return this->boxData; }
+int                         StaticTileIndex::getBoxCount() const         { return this->boxCount; }
+Tile*                       StaticTileIndex::getLeafTile(int leaf) const { return this->tiles[leaf]; }
+const vector<int>&          StaticTileIndex::getLevelEnds() const        { return this->levelEnds; }
+
+// Other methods
+bool StaticTileIndex::checkLevelEnds(const int32_t* levelEnds, int levelCount, int boxCount) {
+    if (levelCount <= 0 || levelEnds[0] <= 0) return false;
+
+    for (int i = 1; i < levelCount; i++) {
+        int64_t childCount = levelEnds[i - 1] - ((i >= 2) ? levelEnds[i - 2] : 0);
+        int64_t nodeCount  = (childCount + StaticTileIndex::NODE_SIZE - 1)/StaticTileIndex::NODE_SIZE;
+
+        if (childCount <= 1 || levelEnds[i] != levelEnds[i - 1] + nodeCount) return false;
+    }
+
+    int64_t rootCount = levelEnds[levelCount - 1] - ((levelCount >= 2) ? levelEnds[levelCount - 2] : 0);
+
+    return rootCount == 1 && levelEnds[levelCount - 1] == boxCount;
+}
+void StaticTileIndex::findPossibleCollisions(AABBCommon& box, vector<Tile*>& acc) const {
+    this->forEachPossibleCollision(box, [&acc](Tile* tile) {
+        acc.push_back(tile);
+        return true;
+    });
+}
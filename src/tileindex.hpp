@@ -0,0 +1,97 @@
+// A read-only spatial index for the tiles of a loaded level
+
+#ifndef TILEINDEX_HPP
+#define TILEINDEX_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "tiles.hpp"
+#include "util.hpp"
+
+using std::vector;
+
+/*
+ * Immutable index over a fixed set of tiles, meant to be built once per level
+ *
+ * Tiles are sorted along a Z-order (Morton) curve so that tiles which are
+ * close to each other in the level are also close to each other in memory.
+ * Groups of NODE_SIZE consecutive tiles are then bounded by a parent node,
+ * groups of those by another parent node, and so on up to a single root node.
+ *
+ * All bounds are stored in one flat array: the tiles' own bounds first, in
+ * Morton order, followed by every level of parent nodes. Because the tree is
+ * packed, a node's children can be found from its position alone, so no child
+ * pointers or indices need to be stored.
+ *
+ * The tiles must not be moved or destroyed while the index is in use.
+ */
+class StaticTileIndex {
+    public:
+        // Bounds in pixel units, as tiles are always grid aligned
+        struct Box {
+            int32_t leftX;
+            int32_t topY;
+            int32_t rightX;
+            int32_t bottomY;
+        };
+    private:
+        static const int NODE_SIZE = 8;
+        static const int MAX_STACK = 128; // Enough for well over 2^31 tiles
+
+        vector<Box>   boxes;     // Tile bounds, then parent nodes' bounds
+        vector<Tile*> tiles;     // Tiles in Morton order, one per leaf box
+        vector<int>   levelEnds; // End of each level in boxes, leaves first
+
+        // Either boxes' contents, or boxes owned by someone else (see the
+        // prebuilt index constructor)
+        const Box* boxData  = nullptr;
+        int        boxCount = 0;
+    public:
+        StaticTileIndex(vector<Tile>& tiles);
+
+        // Use an index which was built beforehand, e.g. stored in a level file
+        // The boxes are used in place, so they must stay valid for as long as
+        // the index is in use
+        // order holds the index into tiles of each leaf box's tile
+        StaticTileIndex(
+            vector<Tile>&   tiles,
+            const Box*      boxes,
+            int             boxCount,
+            const uint32_t* order,
+            const int32_t*  levelEnds,
+            int             levelCount
+        );
+
+        // Copies would still point at the original's boxes
+        StaticTileIndex(const StaticTileIndex&) = delete;
+        StaticTileIndex& operator=(const StaticTileIndex&) = delete;
+
+        // Check that the given level ends describe a valid index with the
+        // given number of boxes, i.e. that every level groups the one below
+        // it into nodes of NODE_SIZE, up to a single root
+        static bool checkLevelEnds(const int32_t* levelEnds, int levelCount, int boxCount);
+
+        int getTileCount() const;
+
+        // The index's contents, for storing it and using it again later
+        const Box*         getBoxes() const;
+        int                getBoxCount() const;
+        Tile*              getLeafTile(int leaf) const;
+        const vector<int>& getLevelEnds() const;
+
+        // Look for tiles whose bounds intersect the given box, calling
+        // visit(Tile* tile) for each of them
+        // The search stops as soon as visit returns false, in which case this
+        // also returns false
+        template <typename B, typename F>
+        bool forEachPossibleCollision(const B& box, F visit) const;
+
+        // Look for tiles whose bounds intersect the given box
+        // Matched tiles are appended to acc, which is not cleared beforehand
+        void findPossibleCollisions(AABBCommon& box, vector<Tile*>& acc) const;
+};
+
+#include "tileindex.tpp"
+
+#endif
@@ -0,0 +1,77 @@
+#include "tileindex.hpp"
+
+#include <algorithm>
+
+#include "tiles.hpp"
+#include "util.hpp"
+
+using std::min;
+
+/* -- StaticTileIndex -- */
+
+template <typename B, typename F>
+bool StaticTileIndex::forEachPossibleCollision(const B& box, F visit) const {
+    if (this->tiles.empty()) return true;
+
+    // Only read the box's bounds once
+    double leftX   = box.getLeftX();
+    double topY    = box.getTopY();
+    double rightX  = box.getRightX();
+    double bottomY = box.getBottomY();
+
+    // Nodes left to be checked, along with which level they're in
+    int stackNodes[StaticTileIndex::MAX_STACK];
+    int stackLevels[StaticTileIndex::MAX_STACK];
+    int stackSize = 0;
+
+    // Uses the same rules as AABBCommon::intersects, so boxes which are only
+    // touching don't count
+    auto overlaps = [&](const Box& other) {
+        return rightX  > other.leftX && leftX < other.rightX
+            && bottomY > other.topY  && topY  < other.bottomY;
+    };
+
+    int rootLevel = this->levelEnds.size() - 1;
+    int root      = this->boxCount - 1;
+
+    if (!overlaps(this->boxData[root])) return true;
+
+    if (rootLevel == 0) {
+        // Only one tile in the index, so the root is a leaf
+        return visit(this->tiles[root]);
+    }
+
+    stackNodes[0] = root;
+    stackLevels[0] = rootLevel;
+    stackSize = 1;
+
+    while (stackSize > 0) {
+        stackSize--;
+        int node  = stackNodes[stackSize];
+        int level = stackLevels[stackSize];
+
+        // Find this node's children from its position within its level
+        int levelStart      = this->levelEnds[level - 1];
+        int childLevelStart = (level >= 2) ? this->levelEnds[level - 2] : 0;
+        int firstChild      = childLevelStart + (node - levelStart)*StaticTileIndex::NODE_SIZE;
+        int lastChild       = min(
+                                  firstChild + StaticTileIndex::NODE_SIZE,
+                                  this->levelEnds[level - 1]
+                              );
+
+        for (int child = firstChild; child < lastChild; child++) {
+            if (!overlaps(this->boxData[child])) continue;
+
+            if (level == 1) {
+                // Children of the lowest level of nodes are the tiles
+                if (!visit(this->tiles[child])) return false;
+            } else {
+                stackNodes[stackSize] = child;
+                stackLevels[stackSize] = level - 1;
+                stackSize++;
+            }
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,12 @@
+// Structures which a World can use for finding tile collisions
+
+#ifndef TILEQUERY_HPP
+#define TILEQUERY_HPP
+
+// To be used with World::tileQueryMode
+const int TILE_QUERY_TREE   = 0; // tilesTree
+const int TILE_QUERY_INDEX  = 1; // tilesIndex
+const int TILE_QUERY_GRID   = 2; // tilesGrid
+const int TILE_QUERY_STREAM = 3; // tilesStream
+
+#endif
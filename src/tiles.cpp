@@ -1,66 +1,68 @@
 #include "tiles.hpp"
 
+#include <stdexcept>
+#include <string>
+
 #include "util.hpp"
 
+using std::to_string;
+
+// The type with the given ID in tileTypesTable
+// Throws std::out_of_range for the reserved ID 0, and IDs not in the table
+static const TileType& findTileType(int typeId) {
+    if (typeId <= 0 || typeId >= TILE_TYPE_COUNT) {
+        throw std::out_of_range("Invalid tile type ID " + to_string(typeId));
+    }
+
+    return tileTypesTable[typeId];
+}
+
 /* -- TileAABB -- */
 
 // Constructors
 TileAABB::TileAABB(int typeId, int gridX, int gridY)
+    : TileAABB(
+          typeId,
+          gridX,
+          gridY,
+          findTileType(typeId).gridWidth,
+          findTileType(typeId).gridHeight
+      ) {}
+TileAABB::TileAABB(int typeId, int gridX, int gridY, int gridWidth, int gridHeight)
     : typeId(typeId),
       gridX(gridX),
-      gridY(gridY) {}
-
-// Getters
-double TileAABB::getTopY() const {
-    return this->gridY*TILEGRID_CELL_SIZE;
-}
-double TileAABB::getBottomY() const {
-    int gridHeight = tileTypesTable.at(this->typeId).gridHeight;
-    return (this->gridY + gridHeight)*TILEGRID_CELL_SIZE;
-}
-double TileAABB::getLeftX() const {
-    return this->gridX*TILEGRID_CELL_SIZE;
-}
-double TileAABB::getRightX() const {
-    int gridWidth = tileTypesTable.at(this->typeId).gridWidth;
-    return (this->gridX + gridWidth)*TILEGRID_CELL_SIZE;
+      gridY(gridY),
+      gridWidth(gridWidth),
+      gridHeight(gridHeight),
+      topY(gridY*TILEGRID_CELL_SIZE),
+      bottomY((gridY + gridHeight)*TILEGRID_CELL_SIZE),
+      leftX(gridX*TILEGRID_CELL_SIZE),
+      rightX((gridX + gridWidth)*TILEGRID_CELL_SIZE) {
+    // Boxes given their own size still need a real type
+    findTileType(typeId);
 }
 
-/* -- TileType -- */
-
-// Constructors
-TileType::TileType(int gridWidth, int gridHeight)
-    : gridWidth(gridWidth),
-      gridHeight(gridHeight) {}
-
 /* -- Tile -- */
 
 // Constructors
 Tile::Tile(int typeId, int gridX, int gridY)
     : bounds(TileAABB(typeId, gridX, gridY)) {}
+Tile::Tile(int typeId, int gridX, int gridY, int gridWidth, int gridHeight)
+    : bounds(TileAABB(typeId, gridX, gridY, gridWidth, gridHeight)) {}
 
 // Getters
 TileAABB& Tile::getBounds()       { return this->bounds; }
 
 // Other methods
 int Tile::getX() const {
-    return this->bounds.gridX*TILEGRID_CELL_SIZE;
+    return this->bounds.leftX;
 }
 int Tile::getY() const {
-    return this->bounds.gridY*TILEGRID_CELL_SIZE;
+    return this->bounds.topY;
 }
 int Tile::getWidth() const {
-    return tileTypesTable.at(this->bounds.typeId).gridWidth*TILEGRID_CELL_SIZE;
+    return this->bounds.gridWidth*TILEGRID_CELL_SIZE;
 }
 int Tile::getHeight() const {
-    return tileTypesTable.at(this->bounds.typeId).gridHeight*TILEGRID_CELL_SIZE;
+    return this->bounds.gridHeight*TILEGRID_CELL_SIZE;
 }
-
-// View the header file for info on constructor structures
-
-const unordered_map<int, TileType> tileTypesTable = {
-    {1, TileType(
-        1,
-        1
-    )}
-};
@@ -5,16 +5,20 @@
 #ifndef TILES_HPP
 #define TILES_HPP
 
+#include <array>
 #include <string>
-#include <unordered_map>
 
+#include "treeitem.hpp"
 #include "util.hpp"
 
+using std::array;
 using std::string;
-using std::unordered_map;
 
 const int TILEGRID_CELL_SIZE = 32;
 
+// Number of entries in tileTypesTable, including the reserved ID 0
+const int TILE_TYPE_COUNT = 2;
+
 class Tile;
 
 // For use with Tile class
@@ -24,30 +28,57 @@ struct TileType {
     const int gridWidth;
     const int gridHeight;
 
-    TileType(int gridWidth, int gridHeight);
+    constexpr TileType(int gridWidth, int gridHeight)
+        : gridWidth(gridWidth),
+          gridHeight(gridHeight) {}
 };
 
-// Tile bounding box
-// "grid" attributes are measured in grid cells
-struct TileAABB : public AABBCommon {
-    int typeId; // References tileTypesTable
-    int gridX;
-    int gridY;
+/*
+ * Tile bounding box
+ * "grid" attributes are measured in grid cells
+ *
+ * The tile's type is only looked up when constructing, and its size is stored
+ * along with the box's edges in pixels, so that the getters (which are called
+ * by every intersection check) don't need to look anything up
+ *
+ * The getters are defined here so that intersectBoxes can inline them
+ *
+ * Throws std::out_of_range if typeId is the reserved ID 0, or isn't in
+ * tileTypesTable
+ */
+struct TileAABB final : public AABBCommon {
+    int    typeId; // References tileTypesTable
+    int    gridX;
+    int    gridY;
+    int    gridWidth;
+    int    gridHeight;
+    double topY;
+    double bottomY;
+    double leftX;
+    double rightX;
 
     TileAABB(int typeId, int gridX, int gridY);
 
-    double getTopY() const override;
-    double getBottomY() const override;
-    double getLeftX() const override;
-    double getRightX() const override;
+    // A box spanning gridWidth*gridHeight cells, rather than the size of a
+    // single tile of the given type
+    // Used for boxes that cover several adjacent tiles of the same type
+    TileAABB(int typeId, int gridX, int gridY, int gridWidth, int gridHeight);
+
+    double getTopY() const override    { return this->topY; }
+    double getBottomY() const override { return this->bottomY; }
+    double getLeftX() const override   { return this->leftX; }
+    double getRightX() const override  { return this->rightX; }
 };
 
 // Represents a single tile in a level
-class Tile {
+class Tile : public QuadTreeItem {
     private:
         TileAABB bounds; // Generated when constructing, based on typeId given
     public:
         Tile(int typeId, int gridX, int gridY);
+
+        // A tile spanning gridWidth*gridHeight cells, see TileAABB
+        Tile(int typeId, int gridX, int gridY, int gridWidth, int gridHeight);
         
         TileAABB& getBounds();
 
@@ -61,7 +92,18 @@ class Tile {
 };
 
 // All TileType definitions go here
-// A TileType's key in this table will be its ID
-extern const unordered_map<int, TileType> tileTypesTable;
+// A TileType's index in this table will be its ID
+// ID 0 is reserved and doesn't represent an actual type
+// Defined here so that lookups can be folded at compile time
+inline constexpr array<TileType, TILE_TYPE_COUNT> tileTypesTable = {
+    TileType( // Reserved
+        0,
+        0
+    ),
+    TileType(
+        1,
+        1
+    )
+};
 
 #endif
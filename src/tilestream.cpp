@@ -0,0 +1,287 @@
+#include "tilestream.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "levelfile.hpp"
+#include "levels.hpp"
+#include "tilegrid.hpp"
+#include "tiles.hpp"
+
+using std::abs, std::max;
+using std::vector;
+
+/* -- StreamingTileIndex::Chunk -- */
+
+// Constructors
+StreamingTileIndex::Chunk::Chunk(int chunkX, int chunkY, vector<Tile> tiles, bool merge)
+    : chunkX(chunkX),
+      chunkY(chunkY),
+      level("", std::move(tiles)) {
+    if (merge) {
+        this->level.mergeCollisionTiles();
+    }
+
+    this->grid = new TileGrid(this->level.getCollisionTiles());
+}
+
+// Destructors
+StreamingTileIndex::Chunk::~Chunk() {
+    delete(this->grid);
+}
+
+/* -- StreamingTileIndex -- */
+
+// Constructors
+StreamingTileIndex::StreamingTileIndex(const LevelFile& file, bool merge, double x, double y)
+    : file(file),
+      merge(merge),
+      chunkPixels(max(file.getChunkSize(), 1)*TILEGRID_CELL_SIZE) {
+    this->loader = std::thread(&StreamingTileIndex::work, this);
+    this->update(x, y);
+}
+
+// Destructors
+StreamingTileIndex::~StreamingTileIndex() {
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->stopping = true;
+    }
+
+    this->chunkRequested.notify_all();
+    this->loader.join();
+
+    for (auto& [index, chunk] : this->loaded) {
+        delete(chunk);
+    }
+
+    for (auto& [index, chunk] : this->done) {
+        delete(chunk);
+    }
+}
+
+// Getters
+int StreamingTileIndex::getLoadedCount() const { return this->loaded.size(); }
+
+const vector<StreamingTileIndex::Chunk*>& StreamingTileIndex::getActiveChunks() const {
+    return this->active;
+}
+
+// Other methods
+int StreamingTileIndex::update(double x, double y) {
+    int chunkX = StreamingTileIndex::toChunk(x, this->chunkPixels);
+    int chunkY = StreamingTileIndex::toChunk(y, this->chunkPixels);
+
+    this->collectLoaded();
+
+    if (this->centered && chunkX == this->centerX && chunkY == this->centerY) {
+        return 0;
+    }
+
+    this->centerX  = chunkX;
+    this->centerY  = chunkY;
+    this->centered = true;
+
+    // Free the chunks which are now too far away
+    for (auto it = this->loaded.begin(); it != this->loaded.end();) {
+        Chunk* chunk = it->second;
+
+        if (this->distanceToCenter(chunk->chunkX, chunk->chunkY) > STREAM_EVICT_RADIUS) {
+            delete(chunk);
+            it = this->loaded.erase(it);
+        } else {
+            it++;
+        }
+    }
+
+    // Every active chunk has to be there before any collisions are checked
+    int side   = 2*STREAM_ACTIVE_RADIUS + 1;
+    int stalls = 0;
+
+    this->active.assign(side*side, nullptr);
+
+    for (int y = 0; y < side; y++) {
+        for (int x = 0; x < side; x++) {
+            int index = this->file.findChunk(
+                chunkX - STREAM_ACTIVE_RADIUS + x,
+                chunkY - STREAM_ACTIVE_RADIUS + y
+            );
+
+            if (index == -1) continue;
+
+            auto found = this->loaded.find(index);
+
+            if (found != this->loaded.end()) {
+                this->active[y*side + x] = found->second;
+            } else {
+                this->active[y*side + x] = this->waitForChunk(index);
+                stalls++;
+            }
+        }
+    }
+
+    // Queue up the chunks around the active ones, nearest first, dropping
+    // the requests which have gone out of range
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+
+        const LevelFileChunk* chunks = this->file.getChunks();
+
+        auto outOfRange = [&](int index) {
+            if (this->distanceToCenter(chunks[index].chunkX, chunks[index].chunkY) <= STREAM_PREFETCH_RADIUS) {
+                return false;
+            }
+
+            this->pending.erase(index);
+            return true;
+        };
+
+        this->requests.erase(
+            std::remove_if(this->requests.begin(), this->requests.end(), outOfRange),
+            this->requests.end()
+        );
+
+        for (int radius = STREAM_ACTIVE_RADIUS + 1; radius <= STREAM_PREFETCH_RADIUS; radius++) {
+            for (int y = chunkY - radius; y <= chunkY + radius; y++) {
+                for (int x = chunkX - radius; x <= chunkX + radius; x++) {
+                    if (this->distanceToCenter(x, y) != radius) continue;
+
+                    int index = this->file.findChunk(x, y);
+
+                    // The loader may have finished a chunk since the last
+                    // collectLoaded(), in which case it's only in done
+                    if (index == -1
+                    ||  this->loaded.count(index) > 0
+                    ||  this->pending.count(index) > 0
+                    ||  std::any_of(this->done.begin(), this->done.end(), [index](auto& entry) {
+                            return entry.first == index;
+                        })) {
+                        continue;
+                    }
+
+                    this->requests.push_back(index);
+                    this->pending.insert(index);
+                }
+            }
+        }
+    }
+
+    this->chunkRequested.notify_one();
+
+    return stalls;
+}
+
+void StreamingTileIndex::findPossibleCollisions(AABBCommon& box, vector<Tile*>& acc) const {
+    this->forEachPossibleCollision(box, [&acc](Tile* tile) {
+        acc.push_back(tile);
+        return true;
+    });
+}
+
+int StreamingTileIndex::toChunk(double position, int chunkPixels) {
+    // Clamped so that chunks next to it can still be counted as ints
+    double chunk = std::floor(position/chunkPixels);
+
+    return static_cast<int>(std::clamp(chunk, double(INT_MIN/2), double(INT_MAX/2)));
+}
+
+int StreamingTileIndex::distanceToCenter(int chunkX, int chunkY) const {
+    return max(abs(chunkX - this->centerX), abs(chunkY - this->centerY));
+}
+
+StreamingTileIndex::Chunk* StreamingTileIndex::loadChunk(int index) const {
+    const LevelFileChunk& chunk   = this->file.getChunks()[index];
+    const LevelFileTile*  records = this->file.getChunkTiles() + chunk.firstTile;
+
+    vector<Tile> tiles;
+    tiles.reserve(chunk.tileCount);
+
+    for (uint32_t i = 0; i < chunk.tileCount; i++) {
+        tiles.emplace_back(
+            records[i].typeId,
+            records[i].gridX,
+            records[i].gridY,
+            records[i].gridWidth,
+            records[i].gridHeight
+        );
+    }
+
+    return new Chunk(chunk.chunkX, chunk.chunkY, std::move(tiles), this->merge);
+}
+
+void StreamingTileIndex::collectLoaded() {
+    std::lock_guard<std::mutex> lock(this->mutex);
+
+    for (auto& [index, chunk] : this->done) {
+        // A chunk that's already loaded is kept, as it may be active
+        if ((this->centered
+        &&   this->distanceToCenter(chunk->chunkX, chunk->chunkY) > STREAM_EVICT_RADIUS)
+        ||  this->loaded.count(index) > 0) {
+            delete(chunk);
+        } else {
+            this->loaded[index] = chunk;
+        }
+    }
+
+    this->done.clear();
+}
+
+StreamingTileIndex::Chunk* StreamingTileIndex::waitForChunk(int index) {
+    {
+        std::unique_lock<std::mutex> lock(this->mutex);
+
+        auto queued = std::find(this->requests.begin(), this->requests.end(), index);
+
+        if (queued != this->requests.end()) {
+            // Not started yet, so it's quicker to load it here
+            this->requests.erase(queued);
+            this->pending.erase(index);
+        } else {
+            this->chunkLoaded.wait(lock, [&]() { return this->pending.count(index) == 0; });
+        }
+    }
+
+    this->collectLoaded();
+
+    auto found = this->loaded.find(index);
+
+    if (found != this->loaded.end()) return found->second;
+
+    Chunk* chunk = this->loadChunk(index);
+    this->loaded[index] = chunk;
+
+    return chunk;
+}
+
+void StreamingTileIndex::work() {
+    std::unique_lock<std::mutex> lock(this->mutex);
+
+    while (true) {
+        this->chunkRequested.wait(lock, [this]() {
+            return this->stopping || !this->requests.empty();
+        });
+
+        if (this->stopping) return;
+
+        int index = this->requests.front();
+        this->requests.pop_front();
+
+        // The file is only read, so the chunk can be loaded without holding
+        // the lock
+        lock.unlock();
+        Chunk* chunk = this->loadChunk(index);
+        lock.lock();
+
+        this->done.emplace_back(index, chunk);
+        this->pending.erase(index);
+        this->chunkLoaded.notify_all();
+    }
+}
@@ -0,0 +1,151 @@
+// A spatial index which streams a level's tiles in chunks around a point
+
+#ifndef TILESTREAM_HPP
+#define TILESTREAM_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "levelfile.hpp"
+#include "levels.hpp"
+#include "tilegrid.hpp"
+#include "tiles.hpp"
+#include "util.hpp"
+
+using std::deque;
+using std::pair;
+using std::unordered_map;
+using std::unordered_set;
+using std::vector;
+
+// How far from the center's chunk, in chunks, chunks are searched for
+// collisions, loaded ahead of time, and kept loaded
+const int STREAM_ACTIVE_RADIUS   = 1;
+const int STREAM_PREFETCH_RADIUS = 2;
+const int STREAM_EVICT_RADIUS    = 3;
+
+/*
+ * Index over the tiles of a level file's chunks, which only holds the chunks
+ * around a center point
+ *
+ * Chunks within STREAM_ACTIVE_RADIUS of the center's chunk are active: only
+ * they are searched for collisions, and they are always loaded by the time
+ * update() returns. Chunks within STREAM_PREFETCH_RADIUS are loaded ahead of
+ * time on a background thread, so that the center moving rarely has to wait
+ * for a chunk, and chunks beyond STREAM_EVICT_RADIUS are freed. Memory use and
+ * query cost only depend on the area around the center, not on the size of
+ * the level.
+ *
+ * Which chunks are active only depends on the center, never on how far the
+ * background thread has got, so collisions play out the same every run.
+ *
+ * Tiles are cut at the chunks' edges when a level file is written, so each
+ * tile only belongs to one chunk. The level file must stay open while the
+ * index is in use.
+ */
+class StreamingTileIndex {
+    public:
+        // A loaded chunk, with a grid over its collision tiles
+        struct Chunk {
+            int       chunkX;
+            int       chunkY;
+            Level     level; // The chunk's tiles, merged like a level's
+            TileGrid* grid;
+
+            Chunk(int chunkX, int chunkY, vector<Tile> tiles, bool merge);
+            Chunk(const Chunk&) = delete;
+            Chunk& operator=(const Chunk&) = delete;
+
+            ~Chunk();
+        };
+    private:
+        const LevelFile& file;
+        bool             merge;
+        int              chunkPixels; // Size of a chunk, in pixels
+
+        // The center's chunk, in chunk coordinates
+        int  centerX  = 0;
+        int  centerY  = 0;
+        bool centered = false;
+
+        // Active chunks, row by row, in the square around the center's chunk
+        // Chunks without any tiles are nullptr
+        vector<Chunk*> active;
+
+        // Chunks owned by this thread, by their index in the level file
+        unordered_map<int, Chunk*> loaded;
+
+        // Shared with the loader thread, only accessed while holding mutex
+        std::thread               loader;
+        std::mutex                mutex;
+        std::condition_variable   chunkRequested;
+        std::condition_variable   chunkLoaded;
+        deque<int>                requests; // Chunks left to load, in order
+        unordered_set<int>        pending;  // Requested and not loaded yet
+        vector<pair<int, Chunk*>> done;     // Loaded, not collected yet
+        bool                      stopping = false;
+
+        // Convert a position to the coordinate of the chunk it's in
+        static int toChunk(double position, int chunkPixels);
+
+        // Distance between the given chunk and the center's chunk, in chunks
+        int distanceToCenter(int chunkX, int chunkY) const;
+
+        // Read a chunk's tiles from the level file, and build its grid
+        // Only reads the file, so it's safe to call from any thread
+        Chunk* loadChunk(int index) const;
+
+        // Take the chunks finished by the loader thread, freeing the ones
+        // that are too far away by now
+        void collectLoaded();
+
+        // Return the given chunk, waiting for the loader thread if it's
+        // already loading it, or loading it on this thread otherwise
+        Chunk* waitForChunk(int index);
+
+        // Loop run by the loader thread
+        void work();
+    public:
+        // Loads the chunks around the given point, and starts the loader
+        // thread
+        // The file must contain chunks
+        StreamingTileIndex(const LevelFile& file, bool merge, double x, double y);
+        StreamingTileIndex(const StreamingTileIndex&) = delete;
+        StreamingTileIndex& operator=(const StreamingTileIndex&) = delete;
+
+        // Stops the loader thread, once it's done with the chunk it's loading
+        ~StreamingTileIndex();
+
+        // Chunks currently held in memory, active or not
+        int getLoadedCount() const;
+
+        const vector<Chunk*>& getActiveChunks() const;
+
+        // Move the center to the given point, in pixels
+        // Chunks that become active are loaded before returning, the ones
+        // around them are queued for the loader thread
+        // Returns how many of the active chunks weren't loaded in advance
+        int update(double x, double y);
+
+        // Look for tiles of the active chunks which could collide with the
+        // given box, calling visit(Tile* tile) for each of them
+        // The search stops as soon as visit returns false, in which case this
+        // also returns false
+        template <typename B, typename F>
+        bool forEachPossibleCollision(const B& box, F visit) const;
+
+        // Look for tiles of the active chunks which could collide with the
+        // given box
+        // Matched tiles are appended to acc, which is not cleared beforehand
+        void findPossibleCollisions(AABBCommon& box, vector<Tile*>& acc) const;
+};
+
+#include "tilestream.tpp"
+
+#endif
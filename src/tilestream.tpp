@@ -0,0 +1,37 @@
+#include "tilestream.hpp"
+
+#include <algorithm>
+
+#include "tilegrid.hpp"
+#include "tiles.hpp"
+
+using std::max, std::min;
+
+/* -- StreamingTileIndex -- */
+
+template <typename B, typename F>
+bool StreamingTileIndex::forEachPossibleCollision(const B& box, F visit) const {
+    if (!this->centered) return true;
+
+    int side    = 2*STREAM_ACTIVE_RADIUS + 1;
+    int activeX = this->centerX - STREAM_ACTIVE_RADIUS;
+    int activeY = this->centerY - STREAM_ACTIVE_RADIUS;
+
+    // Range of active chunks overlapped by the box
+    int firstX = max(StreamingTileIndex::toChunk(box.getLeftX(), this->chunkPixels), activeX);
+    int firstY = max(StreamingTileIndex::toChunk(box.getTopY(), this->chunkPixels), activeY);
+    int lastX  = min(StreamingTileIndex::toChunk(box.getRightX(), this->chunkPixels), activeX + side - 1);
+    int lastY  = min(StreamingTileIndex::toChunk(box.getBottomY(), this->chunkPixels), activeY + side - 1);
+
+    for (int y = firstY; y <= lastY; y++) {
+        for (int x = firstX; x <= lastX; x++) {
+            Chunk* chunk = this->active[(y - activeY)*side + (x - activeX)];
+
+            if (chunk == nullptr) continue;
+
+            if (!chunk->grid->forEachPossibleCollision(box, visit)) return false;
+        }
+    }
+
+    return true;
+}
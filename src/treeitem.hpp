@@ -0,0 +1,32 @@
+// Base class for the items held by a QuadTree
+
+#ifndef TREEITEM_HPP
+#define TREEITEM_HPP
+
+#include <atomic>
+#include <cstdint>
+
+/*
+ * Keeps track of the QuadTree node an item was inserted into, on the item
+ * itself, so that the tree can find it again without a lookup table
+ *
+ * An item can only be in one tree at a time. Copies start out in no tree,
+ * whichever tree the original is in.
+ */
+class QuadTreeItem {
+    template <typename T> friend class QuadTree;
+
+    private:
+        int     treeNode       = -1;
+        int64_t treeGeneration = -1; // The tree's generation while it's in it
+    public:
+        QuadTreeItem() = default;
+        QuadTreeItem(const QuadTreeItem&) {}
+        QuadTreeItem& operator=(const QuadTreeItem&) { return *this; }
+};
+
+// Source of QuadTree generations, shared by every tree so that an item's
+// location from another tree, or from before a clear(), never matches
+inline std::atomic<int64_t> quadTreeGenerations{0};
+
+#endif
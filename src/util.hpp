@@ -1,9 +1,8 @@
-// SDL boilerplate and misc utilities
+// Misc utilities
 
 #ifndef UTIL_HPP
 #define UTIL_HPP
 
-#include <SDL2/SDL.h>
 #include <string>
 
 using std::string;
@@ -22,10 +21,6 @@ const int INTERSECT_Y_TOP    = 1;
 const int INTERSECT_Y_BOTTOM = 2;
 const int INTERSECT_Y_BOTH   = 3;
 
-extern SDL_Window* window;
-extern SDL_Surface* winSurface;
-extern SDL_Surface* gameSurface;
-
 // Generic 2D vector
 template <typename T>
 struct vec2 {
@@ -39,8 +34,6 @@ struct vec2 {
     vec2<double> normalized();
 };
 
-#include "util.tpp"
-
 const vec2<int> INTERSECT_NONE = {INTERSECT_X_NONE, INTERSECT_Y_NONE};
 
 // Properties common to derived AABB types
@@ -57,16 +50,25 @@ struct AABBCommon {
      * 
      * Will return INTERSECT_(X/Y)_BOTH for a coordinate if either box fully
      * contains the other in that coordinate
+     *
+     * Goes through the virtual getters, prefer intersectBoxes in hot code
      */
     vec2<int> intersects(AABBCommon& other) const;
 
     virtual ~AABBCommon() = 0;
 };
 
-// Initialize SDL
-extern bool init();
+/*
+ * Same as AABBCommon::intersects, but the getters are resolved at compile time
+ * based on the types of the boxes, so they don't go through virtual calls and
+ * can be inlined
+ *
+ * Meant for final types derived from AABBCommon (e.g. AABB, TileAABB), which
+ * have their getters defined in their headers
+ */
+template <typename A, typename B>
+vec2<int> intersectBoxes(const A& box, const B& other);
 
-// Quit SDL2
-extern void kill();
+#include "util.tpp"
 
 #endif
\ No newline at end of file
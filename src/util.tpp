@@ -25,4 +25,53 @@ vec2<double> vec2<T>::normalized() {
         this->x / mag,
         this->y / mag
     };
-}
\ No newline at end of file
+}
+
+/* -- AABBCommon helpers -- */
+
+template <typename A, typename B>
+vec2<int> intersectBoxes(const A& box, const B& other) {
+    // Read every edge only once
+    double topY         = box.getTopY();
+    double bottomY      = box.getBottomY();
+    double leftX        = box.getLeftX();
+    double rightX       = box.getRightX();
+    double otherTopY    = other.getTopY();
+    double otherBottomY = other.getBottomY();
+    double otherLeftX   = other.getLeftX();
+    double otherRightX  = other.getRightX();
+
+    // Check intersection in X axis
+    if (rightX <= otherLeftX || leftX >= otherRightX) return INTERSECT_NONE;
+
+    int intersectsX;
+
+    if (leftX < otherLeftX && rightX < otherRightX) {
+        // This box's right side might be touching the other's left side
+        intersectsX = INTERSECT_X_LEFT;
+    } else if (leftX > otherLeftX && rightX > otherRightX) {
+        // This box's left side might be touching the other's right side
+        intersectsX = INTERSECT_X_RIGHT;
+    } else {
+        // This box contains/is contained by the other in the X axis
+        intersectsX = INTERSECT_X_BOTH;
+    }
+
+    // Check intersection in Y axis
+    if (bottomY <= otherTopY || topY >= otherBottomY) return INTERSECT_NONE;
+
+    int intersectsY;
+
+    if (topY < otherTopY && bottomY < otherBottomY) {
+        // This box's bottom side might be touching the other's top side
+        intersectsY = INTERSECT_Y_TOP;
+    } else if (topY > otherTopY && bottomY > otherBottomY) {
+        // This box's top side might be touching the other's bottom side
+        intersectsY = INTERSECT_Y_BOTTOM;
+    } else {
+        // This box contains/is contained by the other in the Y axis
+        intersectsY = INTERSECT_Y_BOTH;
+    }
+
+    return {intersectsX, intersectsY};
+}
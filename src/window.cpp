@@ -0,0 +1,86 @@
+#include "window.hpp"
+
+#include <SDL2/SDL.h>
+#include <iostream>
+
+#include "game.hpp"
+#include "graphics.hpp"
+#include "util.hpp"
+
+using std::cin, std::cout, std::endl;
+
+SDL_Window* window;
+SDL_Surface* winSurface;
+SDL_Surface* gameSurface;
+
+/* -- Utility methods -- */
+
+bool init() {
+    if (SDL_Init(SDL_INIT_EVERYTHING) < 0) {
+        cout << "Error initializing SDL: " << SDL_GetError() << endl;
+        system("pause");
+        return false;
+    }
+
+    window = SDL_CreateWindow(
+        WINDOW_NAME.c_str(),
+        SDL_WINDOWPOS_UNDEFINED,
+        SDL_WINDOWPOS_UNDEFINED,
+        WINDOW_WIDTH,
+        WINDOW_HEIGHT,
+        0
+    );
+    if (!window) {
+        cout << "Error creating window: " << SDL_GetError() << endl;
+        system("pause");
+        return false;
+    }
+
+    winSurface = SDL_GetWindowSurface(window);
+    if (!winSurface) {
+        cout << "Error getting surface: " << SDL_GetError() << endl;
+        system("pause");
+        return false;
+    }
+
+    // Temporary surface, will be formatted into the game surface
+    SDL_Surface* temp = SDL_CreateRGBSurfaceWithFormat(
+        winSurface->flags,
+        winSurface->w,
+        winSurface->h,
+        winSurface->format->BitsPerPixel,
+        winSurface->format->format
+    );
+    if (!temp) {
+        cout << "Error creating game surface: " << SDL_GetError() << endl;
+        system("pause");
+        return false;
+    }
+
+    // Convert game surface to window surface for faster blitting
+    gameSurface = SDL_ConvertSurface(temp, winSurface->format, 0);
+    if (!gameSurface) {
+        cout << "Error formatting game surface: " << SDL_GetError() << endl;
+        system("pause");
+        return false;
+    }
+
+    // Convert all colors to the window surface's format
+    // Colors must initially be Uint32 formatted as RGB
+    for (auto color = debugColors.begin(); color != debugColors.end(); color++) {
+        int r = (color->second & 0xFF0000) >> 4*4;
+        int g = (color->second & 0x00FF00) >> 4*2;
+        int b = (color->second & 0x0000FF) >> 4*0;
+
+        color->second = SDL_MapRGB(winSurface->format, r, g, b);
+    }
+
+    return true;
+}
+
+void kill() {
+    world.clear();
+
+    SDL_DestroyWindow(window);
+    SDL_Quit();
+}
\ No newline at end of file
@@ -0,0 +1,18 @@
+// SDL boilerplate
+
+#ifndef WINDOW_HPP
+#define WINDOW_HPP
+
+#include <SDL2/SDL.h>
+
+extern SDL_Window* window;
+extern SDL_Surface* winSurface;
+extern SDL_Surface* gameSurface;
+
+// Initialize SDL
+extern bool init();
+
+// Quit SDL2
+extern void kill();
+
+#endif
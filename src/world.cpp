@@ -0,0 +1,450 @@
+#include "world.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "boxbatch.hpp"
+#include "input.hpp"
+#include "levelfile.hpp"
+#include "levels.hpp"
+#include "metrics.hpp"
+#include "objects.hpp"
+#include "physics.hpp"
+#include "pool.hpp"
+#include "profiler.hpp"
+#include "quadtree.hpp"
+#include "tilegrid.hpp"
+#include "tileindex.hpp"
+#include "tilestream.hpp"
+#include "tiles.hpp"
+#include "util.hpp"
+
+using std::max, std::min;
+using std::string;
+using std::vector;
+
+/* -- World -- */
+
+// Constructors
+World::World() {
+    this->resizeTrees(2, 2, WINDOW_WIDTH - 2, WINDOW_HEIGHT - 2);
+}
+
+// Destructors
+World::~World() {
+    this->clear();
+
+    delete(this->gameObjectsTree);
+    delete(this->tilesTree);
+    delete(this->tilesIndex);
+    delete(this->tilesGrid);
+    delete(this->tilesStream);
+    delete(this->level);
+    delete(this->levelFile);
+}
+
+// Other methods
+Level* World::loadLevel(string levelName) {
+    LevelFile* file     = new LevelFile(this->levelsDirectory + "/" + levelName + LEVEL_FILE_EXTENSION);
+    bool       streamed = (this->tileQueryMode == TILE_QUERY_STREAM);
+
+    if (!file->isOpen() || (streamed && file->getChunkCount() == 0)) {
+        delete(file);
+        return nullptr;
+    }
+
+    Level*              loadedLevel;
+    StaticTileIndex*    index  = nullptr;
+    StreamingTileIndex* stream = nullptr;
+
+    // Area covered by the window and the level, in pixels
+    double leftX   = 2;
+    double topY    = 2;
+    double rightX  = WINDOW_WIDTH - 2;
+    double bottomY = WINDOW_HEIGHT - 2;
+
+    if (streamed) {
+        // Only the chunks around streamCenter are ever loaded, so the level
+        // itself is left empty
+        loadedLevel = new Level(file->getDisplayName(), vector<Tile>());
+        stream = new StreamingTileIndex(
+            *file,
+            this->mergeLevelTiles,
+            this->streamCenter.x,
+            this->streamCenter.y
+        );
+
+        const LevelFileChunk* chunks    = file->getChunks();
+        double                chunkSize = file->getChunkSize()*TILEGRID_CELL_SIZE;
+
+        for (int i = 0; i < file->getChunkCount(); i++) {
+            leftX   = min(leftX, chunks[i].chunkX*chunkSize);
+            topY    = min(topY, chunks[i].chunkY*chunkSize);
+            rightX  = max(rightX, (chunks[i].chunkX + 1)*chunkSize);
+            bottomY = max(bottomY, (chunks[i].chunkY + 1)*chunkSize);
+        }
+    } else {
+        loadedLevel = new Level(*file, this->mergeLevelTiles);
+
+        // Tiles don't move once loaded, so their spatial structures only need
+        // to be built once
+        // tryMove() always goes through tilesIndex, whatever tileQueryMode is
+        vector<Tile>& collisionTiles = loadedLevel->getCollisionTiles();
+
+        if (file->hasIndex()
+        &&  (file->getMergedCount() > 0) == loadedLevel->hasMergedTiles()) {
+            index = file->createIndex(collisionTiles);
+        } else {
+            index = new StaticTileIndex(collisionTiles);
+        }
+
+        for (Tile& tile : collisionTiles) {
+            TileAABB& bounds = tile.getBounds();
+
+            leftX   = min(leftX, bounds.getLeftX());
+            topY    = min(topY, bounds.getTopY());
+            rightX  = max(rightX, bounds.getRightX());
+            bottomY = max(bottomY, bounds.getBottomY());
+        }
+    }
+
+    this->resizeTrees(leftX, topY, rightX, bottomY);
+
+    if (this->tileQueryMode == TILE_QUERY_TREE) {
+        for (Tile& tile : loadedLevel->getCollisionTiles()) {
+            this->tilesTree->insert(&tile);
+        }
+    }
+
+    delete(this->tilesGrid);
+    this->tilesGrid = (this->tileQueryMode == TILE_QUERY_GRID) ? new TileGrid(loadedLevel->getCollisionTiles()) : nullptr;
+
+    // The old index and stream use the old file, so they go first
+    delete(this->tilesIndex);
+    delete(this->tilesStream);
+    delete(this->level);
+    delete(this->levelFile);
+
+    this->tilesIndex = index;
+    this->tilesStream = stream;
+    this->physics.tiles = index;
+    this->physics.tileStream = stream;
+    this->level = loadedLevel;
+    this->levelFile = file;
+    this->levelName = levelName;
+
+    return loadedLevel;
+}
+
+void World::addGameObject(GameObject* gobj) {
+    this->gameObjects.push_back(gobj);
+    this->gameObjectsTree->insert(gobj);
+}
+
+void World::killGameObject(GameObject* gobj) {
+    gobj->markDead();
+}
+
+void World::destroyGameObject(GameObject* gobj) {
+    switch (gobj->getObjectType()) {
+        case eObjTypes::player:
+            this->playerPool.destroy(static_cast<Player*>(gobj));
+            break;
+        case eObjTypes::projectile:
+            this->projectilePool.destroy(static_cast<Projectile*>(gobj));
+            break;
+        default:
+            delete gobj;
+            break;
+    }
+}
+
+void World::applyPlayerInput(Player* player, const TickInput& input) {
+    ScopedTimer timer("input");
+
+    this->streamCenter = {player->getX(), player->getY()};
+
+    bool left  = input.buttons & INPUT_LEFT;
+    bool right = input.buttons & INPUT_RIGHT;
+
+    // Walking
+    if (left && !right) {
+        player->setState("walk");
+        player->walk(DIR_LEFT);
+    } else if (right && !left) {
+        player->setState("walk");
+        player->walk(DIR_RIGHT);
+    } else if (player->getState() == "walk") {
+        player->setSpeedX(0);
+        player->setState("stand");
+    }
+
+    // Have the player aim at and face the cursor
+    // Compared against the simulated position rather than the rendered one,
+    // so that replaying the same inputs always leads to the same result
+    player->aimAt({
+        static_cast<double>(input.aimX),
+        static_cast<double>(input.aimY)
+    });
+
+    if (input.aimX < player->getX()) {
+        player->setDirection(DIR_LEFT);
+    } else if (input.aimX > player->getX()) {
+        player->setDirection(DIR_RIGHT);
+    }
+
+    //TEMP: fire projectiles with M1
+    if ((input.buttons & INPUT_FIRE)
+    && !(this->lastPlayerInput.buttons & INPUT_FIRE)) {
+        Projectile* proj = this->projectilePool.create(this->physics, this->playerPool, player, 90, 15, 15);
+        proj->teleport(
+            player->getAimX(),
+            player->getAimY()
+        );
+        proj->setWeight(0.85);
+        proj->thrust(
+            14 * player->getAimDirection().x,
+            14 * player->getAimDirection().y
+        );
+
+        this->addGameObject(proj);
+    }
+
+    this->lastPlayerInput = input;
+}
+
+void World::step() {
+    ScopedTimer timer("simulation");
+
+    // Counters only cover the latest tick
+    if (metricsEnabled) resetCounters();
+
+    // Make sure the chunks around the player are there before anything moves
+    if (this->tilesStream != nullptr) {
+        ScopedTimer streamTimer("stream");
+
+        int stalls = this->tilesStream->update(this->streamCenter.x, this->streamCenter.y);
+
+        if (metricsEnabled) {
+            streamChunks.set(this->tilesStream->getLoadedCount());
+            streamStalls.add(stalls);
+        }
+    }
+
+    /* -- Physics -- */
+
+    // Apply gravity to all objects, then displace them based on their speed
+    // These go linearly through physics's arrays
+    {
+        ScopedTimer integrateTimer("integrate");
+
+        this->physics.applyGravity();
+        this->physics.integrate();
+    }
+
+    this->tickGameObjects();
+    this->removeDeadGameObjects();
+
+    // Merge back quadrants that were emptied by moved and killed objects
+    {
+        ScopedTimer pruneTimer("tree_prune");
+
+        this->gameObjectsTree->prune();
+    }
+
+    /* -- Collision -- */
+
+    // Without a level, there are no tiles to collide with
+    if (this->level != nullptr) {
+        this->resolveTileCollisions();
+    }
+
+    if (metricsEnabled) {
+        QuadTree<GameObject>::Stats stats = this->gameObjectsTree->getStats();
+
+        quadTreeNodes.set(stats.nodes);
+        quadTreeDepth.set(stats.depth);
+        quadTreeInnerItems.set(stats.innerItems);
+    }
+
+    this->ticks++;
+}
+
+void World::clear() {
+    for (GameObject* gobj : this->gameObjects) {
+        this->destroyGameObject(gobj);
+    }
+
+    this->gameObjects.clear();
+    this->gameObjectsTree->clear();
+
+    this->lastPlayerInput = TickInput();
+}
+
+template <typename B, typename F>
+void World::forEachPossibleTileCollision(const B& box, F visit) {
+    // The structures are only built once a level is loaded
+    if (this->level == nullptr) return;
+
+    switch (this->tileQueryMode) {
+        case TILE_QUERY_TREE:
+            this->tilesTree->forEachPossibleCollision(box, visit);
+            break;
+        case TILE_QUERY_INDEX:
+            this->tilesIndex->forEachPossibleCollision(box, visit);
+            break;
+        case TILE_QUERY_GRID:
+            this->tilesGrid->forEachPossibleCollision(box, visit);
+            break;
+        case TILE_QUERY_STREAM:
+            this->tilesStream->forEachPossibleCollision(box, visit);
+            break;
+    }
+}
+
+void World::tickGameObjects() {
+    ScopedTimer timer("tick_objects");
+
+    for (GameObject* gobj : this->gameObjects) {
+        // Objects too fast for integrate() are moved with a swept test
+        // instead, so that they can't pass through tiles
+        if (this->physics.needsSweep(gobj->getSlot())) {
+            gobj->tryMove(
+                gobj->getX() + gobj->getSpeedX(),
+                gobj->getY() + gobj->getSpeedY()
+            );
+        }
+
+        // Run the object's specific logic for this tick
+        gobj->tick();
+
+        // Kill object if it's out of health
+        if (gobj->getHealth() <= 0) {
+            this->killGameObject(gobj);
+            continue;
+        }
+
+        // Only objects that have moved need to be relocated in the tree
+        if (this->physics.hasMoved(gobj->getSlot())) {
+            this->updateGameObjectsTree(gobj);
+        }
+    }
+}
+
+void World::resolveTileCollisions() {
+    ScopedTimer timer("collision");
+
+    for (GameObject* gobj : this->gameObjects) {
+        bool resolved = false;
+
+        for (int i = 0; i < MAX_CONTACT_ITERATIONS; i++) {
+            AABB bounds = gobj->getBounds();
+
+            this->tileContacts.clear();
+
+            // Test the gobj against all tiles in tileBatch at once, adding
+            // the ones it's colliding with to tileContacts
+            // tileContacts works out the push from the overlaps, so the
+            // batch's side codes are skipped
+            auto checkTileBatch = [&]() {
+                uint64_t hits = intersectBatch(bounds, this->tileBatch, nullptr);
+
+                if (metricsEnabled) {
+                    intersectTests.add(this->tileBatch.count);
+                    intersectHits.add(countBits(hits));
+                }
+
+                while (hits != 0) {
+                    this->tileContacts.add(bounds, this->tileBatchTiles[lowestBit(hits)]->getBounds());
+                    hits &= hits - 1;
+                }
+
+                this->tileBatch.clear();
+            };
+
+            if (metricsEnabled) {
+                tileQueries.add();
+
+                if (i > 0) contactRestarts.add();
+            }
+
+            // Gather every tile the gobj is colliding with in a single query
+            this->forEachPossibleTileCollision(bounds, [&](Tile* possibleCol) {
+                if (metricsEnabled) tileCandidates.add();
+
+                this->tileBatchTiles[this->tileBatch.count] = possibleCol;
+                this->tileBatch.add(possibleCol->getBounds());
+
+                if (this->tileBatch.isFull()) {
+                    checkTileBatch();
+                }
+
+                return true;
+            });
+
+            if (this->tileBatch.count > 0) {
+                checkTileBatch();
+            }
+
+            if (this->tileContacts.count == 0) break;
+
+            // Resolving the contacts can push the gobj into other tiles, so
+            // check again, up to MAX_CONTACT_ITERATIONS times
+            gobj->onCollideTiles(this->tileContacts);
+            resolved = true;
+        }
+
+        // The gobj may have changed position, so update the tree
+        if (resolved) {
+            this->updateGameObjectsTree(gobj);
+        }
+    }
+}
+
+void World::removeDeadGameObjects() {
+    ScopedTimer timer("remove_dead");
+
+    int kept = 0;
+
+    for (GameObject* gobj : this->gameObjects) {
+        if (gobj->isDead()) {
+            this->gameObjectsTree->remove(gobj);
+            this->destroyGameObject(gobj);
+        } else {
+            this->gameObjects[kept] = gobj;
+            kept++;
+        }
+    }
+
+    this->gameObjects.resize(kept);
+}
+
+void World::updateGameObjectsTree(GameObject* gobj) {
+    if (metricsEnabled) treeUpdates.add();
+
+    this->gameObjectsTree->update(gobj);
+
+    if (this->onSubtick != nullptr) {
+        this->onSubtick();
+    }
+}
+
+void World::resizeTrees(double leftX, double topY, double rightX, double bottomY) {
+    AABB bounds(
+        {(leftX + rightX)/2, (topY + bottomY)/2},
+        (rightX - leftX)/2,
+        (bottomY - topY)/2
+    );
+
+    delete(this->gameObjectsTree);
+    this->gameObjectsTree = new QuadTree<GameObject>(bounds);
+
+    delete(this->tilesTree);
+    this->tilesTree = new QuadTree<Tile>(bounds);
+
+    for (GameObject* gobj : this->gameObjects) {
+        this->gameObjectsTree->insert(gobj);
+    }
+}
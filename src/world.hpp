@@ -0,0 +1,195 @@
+// Physics and collision logic for the objects and tiles of a simulation
+// Doesn't depend on SDL, so that it can also run without a window
+
+#ifndef WORLD_HPP
+#define WORLD_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "boxbatch.hpp"
+#include "input.hpp"
+#include "levelfile.hpp"
+#include "levels.hpp"
+#include "objects.hpp"
+#include "physics.hpp"
+#include "pool.hpp"
+#include "quadtree.hpp"
+#include "tilegrid.hpp"
+#include "tilequery.hpp"
+#include "tileindex.hpp"
+#include "tilestream.hpp"
+#include "tiles.hpp"
+#include "util.hpp"
+
+using std::string;
+using std::vector;
+
+// Max. times an object's tile contacts are gathered and resolved per tick
+const int MAX_CONTACT_ITERATIONS = 4;
+
+/*
+ * A self-contained simulation: a level, the objects in it, and the structures
+ * used for finding their collisions
+ *
+ * Worlds share no mutable state with each other, so separate worlds can be
+ * stepped on separate threads at the same time. The only exception is the
+ * counters in metrics.hpp, which should be left disabled while doing so.
+ */
+class World {
+    private:
+        // Bounds of the tiles currently being checked for collisions, and the
+        // tiles themselves, reused by every collision check
+        BoxBatch tileBatch;
+        Tile*    tileBatchTiles[BOX_BATCH_SIZE];
+
+        // Tile contacts of the object currently being checked for collisions
+        ContactManifold tileContacts;
+
+        // Calls visit(Tile* tile) for each tile that could collide with the
+        // given box, using the structure selected by tileQueryMode
+        // The search stops as soon as visit returns false
+        // Visits nothing if no level is loaded
+        template <typename B, typename F>
+        void forEachPossibleTileCollision(const B& box, F visit);
+
+        // Moves objects that are too fast for PhysicsWorld::integrate, runs
+        // their per-tick logic and kills the ones that are out of health
+        void tickGameObjects();
+
+        // Gathers and resolves the tile contacts of every object
+        void resolveTileCollisions();
+
+        // Removes and destroys all killed objects in a single pass over
+        // gameObjects, keeping the remaining objects in the same order
+        void removeDeadGameObjects();
+
+        // Relocates the object within gameObjectsTree, if it has left its node
+        void updateGameObjectsTree(GameObject* gobj);
+
+        // Replaces both trees with ones covering the given area, in pixels,
+        // reinserting every object in gameObjects
+        void resizeTrees(double leftX, double topY, double rightX, double bottomY);
+    public:
+        // Ticks simulated by step() so far
+        int64_t ticks = 0;
+
+        // Directory which loadLevel() looks for level files in
+        string levelsDirectory = LEVELS_DIRECTORY;
+
+        // The loaded level, owned by the world, and the name it was loaded
+        // with
+        Level* level     = nullptr;
+        string levelName = "";
+
+        // The loaded level's file, kept open as tilesIndex may use its boxes
+        LevelFile* levelFile = nullptr;
+
+        // The objects currently present in the world
+        vector<GameObject*> gameObjects;
+
+        // Physics state of all objects in gameObjects
+        PhysicsWorld physics;
+
+        // Pools which the objects in gameObjects are allocated from, one per
+        // type
+        // Declared after physics, as objects still alive when a pool is
+        // destroyed release their physics slot
+        ObjectPool<Player>     playerPool;
+        ObjectPool<Projectile> projectilePool;
+
+        // Tree structure containing pointers to the bounding boxes of all
+        // objects in gameObjects
+        QuadTree<GameObject>* gameObjectsTree = nullptr;
+
+        // Tree structure containing pointers to the bounding boxes of all
+        // level tiles currently loaded
+        // Both trees cover the window and the loaded level
+        QuadTree<Tile>* tilesTree = nullptr;
+
+        // Read-only index of all level tiles currently loaded, built once per
+        // level
+        StaticTileIndex* tilesIndex = nullptr;
+
+        // Lookup table from grid cells to the level tiles currently loaded,
+        // built once per level
+        TileGrid* tilesGrid = nullptr;
+
+        // Chunks of the level around streamCenter, loaded and freed as it
+        // moves
+        StreamingTileIndex* tilesStream = nullptr;
+
+        // Point which tilesStream is centered on, in pixels
+        // Moved to the player by applyPlayerInput(), and followed by tilesStream
+        // at the start of every step()
+        vec2<double> streamCenter = {WINDOW_WIDTH/2, WINDOW_HEIGHT/2};
+
+        // Which structure to use for tile collision checks, uses TILE_QUERY_*
+        // constants
+        // tilesTree, tilesGrid and tilesStream are only populated for the mode
+        // they're used by, so this must be set before loading a level
+        // With TILE_QUERY_STREAM, the level's tiles are never loaded all at
+        // once: only the chunks around streamCenter are kept in memory
+        int tileQueryMode = TILE_QUERY_GRID;
+
+        // Whether or not to merge adjacent level tiles into larger ones when
+        // loading a level, to reduce the number of tiles to check collisions
+        // against
+        bool mergeLevelTiles = true;
+
+        // Called whenever an object is relocated within gameObjectsTree
+        // mid-tick, if set
+        // Meant for debugging, e.g. rendering every step of the collision
+        // phase
+        void (*onSubtick)() = nullptr;
+
+        // Input given to the last applyPlayerInput() call
+        TickInput lastPlayerInput;
+
+        World();
+        World(const World&) = delete;
+        World& operator=(const World&) = delete;
+
+        // Destroys all objects, the loaded level and the collision structures
+        ~World();
+
+        // Loads the specified level's file from levelsDirectory, replacing the
+        // loaded level
+        // Also builds tilesIndex over the level's collision tiles, using the
+        // file's prebuilt index when it matches mergeLevelTiles, and
+        // tilesTree or tilesGrid depending on tileQueryMode
+        // With TILE_QUERY_STREAM, only tilesStream is built instead, and the
+        // level itself holds no tiles
+        // Both trees are resized to cover the level
+        // Returns nullptr if there's no valid level file with that name, or
+        // it can't be streamed, in which case the loaded level is kept
+        Level* loadLevel(string levelName);
+
+        // Adds an object to gameObjects and gameObjectsTree
+        // The object must have been created from this world's pools
+        void addGameObject(GameObject* gobj);
+
+        // Kills an object, which is removed from gameObjects at the end of the
+        // current tick's physics phase
+        void killGameObject(GameObject* gobj);
+
+        // Destroys an object, returning it to the pool of its type
+        // Does NOT remove it from gameObjects or gameObjectsTree
+        void destroyGameObject(GameObject* gobj);
+
+        // Makes the player walk, aim and shoot based on a tick's input, and
+        // moves streamCenter to them
+        // Projectiles are only fired on the first tick the fire button is
+        // held, going by the input given to the previous call
+        void applyPlayerInput(Player* player, const TickInput& input);
+
+        // Advances all objects in gameObjects by one tick, then resolves their
+        // collisions with the loaded level's tiles, if a level is loaded
+        void step();
+
+        // Destroys all objects, the level stays loaded
+        void clear();
+};
+
+#endif
@@ -0,0 +1,43 @@
+// Converts every level in levelsTable into a level file
+// Usage: 2d-physics-levelconv [output directory]
+// The output directory defaults to the one the game looks for levels in
+// Each level is written to <output directory>/<name>.lvl, along with its
+// merged collision tiles and a prebuilt index over them, so that loading it
+// doesn't need to do either
+
+#include <iostream>
+#include <string>
+
+#include "levelfile.hpp"
+#include "levels.hpp"
+#include "levelstable.hpp"
+
+using std::cout, std::cerr;
+using std::string;
+
+int main(int argc, char** argv) {
+    string directory = (argc > 1) ? argv[1] : LEVELS_DIRECTORY;
+
+    for (auto& [name, tableLevel] : levelsTable) {
+        Level  level = tableLevel;
+        string path  = directory + "/" + name + LEVEL_FILE_EXTENSION;
+
+        if (!isValidLevelName(name)) {
+            cerr << "ERROR: \"" << name << "\" isn't a valid level name" << '\n';
+            return 1;
+        }
+
+        level.mergeCollisionTiles();
+
+        if (!writeLevelFile(path, level)) {
+            cerr << "ERROR: Couldn't write " << path << '\n';
+            return 1;
+        }
+
+        cout << path << ": "
+             << level.getTiles().size() << " tiles, "
+             << level.getCollisionTiles().size() << " merged" << '\n';
+    }
+
+    return 0;
+}
@@ -0,0 +1,144 @@
+#include "levelstable.hpp"
+
+#include <string>
+#include <unordered_map>
+
+#include "levels.hpp"
+#include "tiles.hpp"
+
+using std::string;
+using std::unordered_map;
+
+const unordered_map<string, Level> levelsTable = {
+    {"test", Level(
+        "Test",
+        {
+            Tile(
+                1,
+                6,
+                13
+            ),
+            Tile(
+                1,
+                7,
+                13
+            ),
+            Tile(
+                1,
+                8,
+                13
+            ),
+            Tile(
+                1,
+                9,
+                13
+            ),
+            Tile(
+                1,
+                10,
+                13
+            ),
+            Tile(
+                1,
+                10,
+                12
+            ),
+            Tile(
+                1,
+                10,
+                11
+            ),
+            Tile(
+                1,
+                10,
+                10
+            ),
+            Tile(
+                1,
+                11,
+                10
+            ),
+            Tile(
+                1,
+                12,
+                10
+            ),
+            Tile(
+                1,
+                13,
+                10
+            ),
+            Tile(
+                1,
+                14,
+                10
+            ),
+            Tile(
+                1,
+                15,
+                10
+            ),
+            Tile(
+                1,
+                16,
+                10
+            ),
+            Tile(
+                1,
+                17,
+                10
+            ),
+            Tile(
+                1,
+                18,
+                10
+            ),
+            Tile(
+                1,
+                19,
+                10
+            ),
+            Tile(
+                1,
+                20,
+                10
+            ),
+            Tile(
+                1,
+                20,
+                11
+            ),
+            Tile(
+                1,
+                20,
+                12
+            ),
+            Tile(
+                1,
+                20,
+                13
+            ),
+            Tile(
+                1,
+                21,
+                13
+            ),
+            Tile(
+                1,
+                22,
+                13
+            ),
+            Tile(
+                1,
+                23,
+                13
+            ),
+            Tile(
+                1,
+                24,
+                13
+            )
+        }
+    )}
+};
+
@@ -0,0 +1,18 @@
+// Level definitions which level files are generated from, see levelconv.cpp
+
+#ifndef LEVELSTABLE_HPP
+#define LEVELSTABLE_HPP
+
+#include <string>
+#include <unordered_map>
+
+#include "levels.hpp"
+
+using std::string;
+using std::unordered_map;
+
+// All Level definitions go here, keyed by the name they're loaded with
+// Each one also needs its file listed in LEVEL_FILES in CMakeLists.txt
+extern const unordered_map<string, Level> levelsTable;
+
+#endif